@@ -3,61 +3,68 @@
 //
 
 /* Introduction
- *
- * !!! WARNING !!!
- * ! The program works almost perfectly fine with one exception.
- * ! When using std::cin and the corresponding operator>> the syntax
- * ! while(std::cin >> aint) does not work properly.
- * ! The program runs to the end (as it can be seen when looking at the exit code)
- * ! but all io-streams seem to be broken meaning that even simple outputs like
- * ! std::cout << "Hello World" << std::endl; will not be printed anymore.
- * ! The program works fine when the input is NOT ended by the EOF but rather by the loop.
- * !
- * ! This means the following will NOT work:
- * !    aint temp{};
- * !    while(std::cin >> temp){
- * !        //do stuff;
- * !    }
- * !
- * ! Whereas this will work:
- * !    aint temp{};
- * !    for(size_t i1 = 0; i < N; ++i){
- * !        // do stuff
- * !    }
- * !
- * ! I think this has to do with the bit flags but I can't figure out why the input stream breaks the output stream!
- * ! As mentioned above the program finishes with the correct exit code and when inspected in a debugger one can see
- * ! that variables get updated and computed correctly.
- * !
- * ! Again, this is not an error in the arithmetic operators but simply a bug in the io-streams
- * ! so the program can be tested using above described for loops
- *
  *
  * The program works roughly like this:
  *
- * A number consists of multiple "blocks" which are stored in an dynamic array. Each block is of data type uint32_t.
+ * A number consists of multiple "blocks" which are stored in an dynamic array. Each block is of data type uint64_t
+ * so that a 64-bit machine handles one block per loop iteration. Carries and products of two blocks are computed in
+ * an unsigned __int128 (double block) which the compiler maps to the add-with-carry and 64x64->128 multiply
+ * instructions.
  * The blocks in the array are stored from LSB to MSB but the bits in a block are stored from MSB to LSB.
  * The container therefore has to be read somewhat similar to a hebrew book where you would read from first to last
  * page but on each page you would read from right to left.
  *
- * When reading in input we fill a block until we have read in 32 bits and then we append the block to the container
+ * When reading in input we fill a block until we have read in 64 bits and then we append the block to the container
  * using the function push_back. If the input ends while still filling a block we push_back that block.
  * Since we want to keep track of the exact number of stored bits we keep a counter for the stored blocks
  * in the container and also for the bits actually used in the last block.
+ * Like the extractors of the built-in types operator>> skips leading whitespace and sets failbit if no binary digit
+ * follows, so while(std::cin >> number) stops at the end of the input.
+ * The digits are not read one by one but straight out of the buffer of the stream, 16 (SSE2) or 32 (AVX2) characters
+ * at a time with one comparison against '0' and '1' each whose movemask already yields the bits in input order.
+ * The output works the other way round: to_chars expands every byte of a block with a table of 256 times 8 characters
+ * and operator<< hands the whole text to the stream in one write.
+ * Decimal and hexadecimal text with the most significant digit first is available through to_string(), from_string()
+ * and the stream manipulators aint_dec and aint_hex (see aint_radix.cpp).
+ * Many numbers are stored with their raw blocks in a binary file which is mapped into memory for reading, the
+ * numbers then use the mapped blocks as storage without a copy (see aint_file.cpp).
+ * Blocks which do not belong to an aint, like such a mapping or a part of another number, are read through an
+ * aint_view. The view holds an aint whose storage points to the blocks with an allocator that never releases them,
+ * so it passes for a const aint in every operation. Slices of the lower or upper blocks are views themselves.
  *
  * This design has the advantage that we can easily implement arithmetic operators using the simple school methods
  * of addition, subtraction and multiplication.
- * For division and modulo we use the binary version of the long division algorithm as it is described here:
- * https://en.wikipedia.org/wiki/Division_algorithm#long_division
+ * The actual loops over the blocks live in a small layer of kernels on raw arrays (see aint_kernels.hpp) like
+ * add_n, sub_n, mul_1 or addmul_1 which propagate carries and borrows. The operators only take care of memory and
+ * the bookkeeping of number_blocks and bits_used, so there is one place to optimise the arithmetic.
+ * Large products switch from the school method to Karatsuba, Toom-Cook 3-way and finally a number theoretic
+ * transform (see aint_mul.cpp).
+ * For division and modulo we use the schoolbook long division with one block of the quotient per step
+ * (Knuth's Algorithm D, see aint_div.cpp). The dividend is reduced to the remainder in place.
+ * The greatest common divisor gcd() does not divide repeatedly but follows Lehmer's algorithm (see aint_gcd.cpp)
+ * and for large numbers the recursive half gcd (see aint_hgcd.cpp).
+ * Many reductions by the same modulus share the constants of Barrett's and Montgomery's methods in a modulus object
+ * (see aint_mod.cpp) and need no division at all.
+ * The gcds of many numbers with the products of all other numbers are found at once with product and remainder
+ * trees on all cores (batch_gcd(), see aint_batch.cpp).
  *
  * Comparison operators are also largely based on comparing the number of blocks and used bits first and
  * only in extreme cases iterate over the entire array.
  *
- * Accumulative operators are implemented by reusing binary arithmetic operators.
+ * Accumulative operators work in place on the storage of the object and only reallocate if the capacity is too small.
+ * mul(), addmul(), submul(), add_shifted() and sub_shifted() write into an existing number as well and take the
+ * place of chains like r = r + a * b, the opt-in expression templates of aint_expr.hpp map whole expressions onto them.
+ * Binary division and modulo are implemented on top of divmod() which delivers quotient and remainder of one division.
  * Bit shift operators make a simplification by first computing the number of entire blocks that will be added in case
  * of operator<< or cut off in case of operator>>.
  *
  * Memory management is mostly done by the functions reserve() and shrink() or in case of constructors by hand.
+ * Heap storage is taken from a block_allocator (see aint_alloc.hpp): by default a thread local pool with power of two
+ * size classes, or whatever allocator an allocator_scope installed, e.g. a block_arena around a batch computation.
+ * How much headroom a number reserves is decided by the growth policy of that allocator.
+ * Numbers of up to inline_blocks blocks live in a buffer inside the object itself so that small values never
+ * allocate. Only larger numbers use heap storage. Constants do not need a temporary aint at all since every operator
+ * also accepts a single word (uint64_t) and then works with the single block kernels like add_1 or mul_1.
  * In general memory management aims to give all aint objects a certain buffer to prevent immediate reallocation after
  * arithmetic operations like for instance operator+=.
  * The function shrink() is intended to free used memory not needed anymore (like after operator-=) while still
@@ -65,29 +72,38 @@
  *
  *
  */
+#include <array>
+#include <cctype>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <streambuf>
+#include <utility>
 #include "aint.hpp"
+#include "aint_kernels.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using kernel::significant_bits;
 
 // public member functions
 
 // constructors for "small" long numbers
-aint::aint(const uint32_t value)
+aint::aint(const uint64_t value)
 {
     if(value != 0)
     {
-        size_t counter = 32;
-
-        // since value != 0 there has to be a MSB
-        while( !( value & ( 1 << (counter - 1) ) ) )
-            --counter;
-
-        capacity = 1;
-
+        // a single block always fits into the inline buffer
         number_blocks = 1;
 
-        storage = new uint32_t[1]{value};
+        storage[0] = value;
 
-        bits_used = counter;
+        // since value != 0 there has to be a MSB
+        bits_used = significant_bits(value);
     }
 
 }
@@ -98,17 +114,20 @@ aint::aint(const aint& other)
 {
     if(other.number_blocks)
     {
-        // intended cropping when converting to size_t
-        // reserve some headroom to avoid immediate reallocation for arithmetic operators
-        // don't use other.capacity since it might be that other.capacity == other.number_blocks already
-        capacity = static_cast<size_t>(other.number_blocks * 1.5l) + 1;
+        // small numbers are copied into the inline buffer
+        if(other.number_blocks > inline_blocks)
+        {
+            // reserve some headroom according to the growth policy to avoid immediate reallocation
+            // don't use other.capacity since it might be that other.capacity == other.number_blocks already
+            capacity = grow(other.number_blocks);
+
+            storage = block_allocator::acquire(capacity, allocator);
+        }
 
         number_blocks = other.number_blocks;
 
         bits_used = other.bits_used;
 
-        storage = new uint32_t[capacity]{0};
-
         for(size_t i1 = 0; i1 < number_blocks; ++i1)
             storage[i1] = other.storage[i1];
     }
@@ -120,22 +139,32 @@ aint::aint(aint&& other) noexcept
 {
     if(other.number_blocks)
     {
-        capacity = other.capacity;
+        // heap storage can be stolen but the inline buffer has to be copied
+        if(other.storage != other.local_storage)
+        {
+            capacity = other.capacity;
 
-        number_blocks = other.number_blocks;
+            storage = other.storage;
 
-        storage = other.storage;
+            allocator = other.allocator;
 
-        bits_used = other.bits_used;
+            other.capacity = inline_blocks;
 
-        // leave the other object in a well defined state
-        other.capacity = 0;
+            other.storage = other.local_storage;
+        }
+
+        else
+        {
+            for(size_t i1 = 0; i1 < inline_blocks; ++i1)
+                storage[i1] = other.storage[i1];
+        }
 
-        other.number_blocks = 0;
+        number_blocks = other.number_blocks;
 
-        other.storage = nullptr;
+        bits_used = other.bits_used;
 
-        other.bits_used = 0;
+        // leave the other object in a well defined state
+        other.release();
     }
 }
 
@@ -143,15 +172,20 @@ aint::aint(aint&& other) noexcept
 // destructor does not to be virtual since inheritance is disabled
 aint::~aint()
 {
-    delete[] storage;
+    if(storage != local_storage)
+        block_allocator::give_back(storage, capacity, allocator);
 }
 
 
-// copy assignment from uint32_t
-aint& aint::operator=(const uint32_t other)
+// copy assignment from uint64_t
+aint& aint::operator=(const uint64_t other)
 {
-    // make use of the move assignment operator who will also free the currently held data
-    *this = aint{other};
+    // a single block always fits into the current storage which is kept for later use
+    storage[0] = other;
+
+    number_blocks = other ? 1 : 0;
+
+    bits_used = other ? significant_bits(other) : 0;
 
     return *this;
 }
@@ -163,25 +197,24 @@ aint& aint::operator=(const aint& other)
     if(this == &other)
         return *this;
 
-    // release owned resources
-    delete[] storage;
+    // the current storage is reused if it is large enough, otherwise the owned resources are released
+    if(other.number_blocks > capacity)
+    {
+        release();
 
-    // intended cropping when converting to size_t
-    // reserve some headroom to avoid immediate reallocation for arithmetic operators
-    // don't use other.capacity since it might be that other.capacity == other.number_blocks already
-    capacity = static_cast<size_t>(other.number_blocks * 1.5l) + 1;
+        // reserve some headroom according to the growth policy to avoid immediate reallocation
+        // don't use other.capacity since it might be that other.capacity == other.number_blocks already
+        capacity = grow(other.number_blocks);
+
+        storage = block_allocator::acquire(capacity, allocator);
+    }
 
     number_blocks = other.number_blocks;
 
     bits_used = other.bits_used;
 
-    if(number_blocks)
-    {
-        storage = new uint32_t[capacity]{0};
-
-        for (size_t i1 = 0; i1 < number_blocks; ++i1)
-            storage[i1] = other.storage[i1];
-    }
+    for (size_t i1 = 0; i1 < number_blocks; ++i1)
+        storage[i1] = other.storage[i1];
 
     return *this;
 }
@@ -193,24 +226,34 @@ aint& aint::operator=(aint&& other) noexcept
     // check against self assignment via std::move() is the user's responsibility
 
     // release owned resources
-    delete[] storage;
+    release();
+
+    // heap storage can be stolen but the inline buffer has to be copied
+    if(other.storage != other.local_storage)
+    {
+        capacity = other.capacity;
 
-    capacity = other.capacity;
+        storage = other.storage;
 
-    number_blocks = other.number_blocks;
+        allocator = other.allocator;
 
-    bits_used = other.bits_used;
+        other.capacity = inline_blocks;
 
-    storage = other.storage;
+        other.storage = other.local_storage;
+    }
 
-    //leave the other object in a well defined state
-    other.capacity = 0;
+    else
+    {
+        for(size_t i1 = 0; i1 < inline_blocks; ++i1)
+            storage[i1] = other.storage[i1];
+    }
 
-    other.number_blocks = 0;
+    number_blocks = other.number_blocks;
 
-    other.bits_used = 0;
+    bits_used = other.bits_used;
 
-    other.storage = nullptr;
+    //leave the other object in a well defined state
+    other.release();
 
     return *this;
 }
@@ -226,663 +269,1707 @@ bool aint::zero() const
 // swaps values of two aints
 void aint::swap(aint& other)
 {
-    aint temp = std::move(other);
+    bool this_local = (storage == local_storage);
+
+    bool other_local = (other.storage == other.local_storage);
+
+    // exchange the inline buffers and all members, then let a pointer to an inline buffer follow its content
+    for(size_t i1 = 0; i1 < inline_blocks; ++i1)
+        std::swap(local_storage[i1], other.local_storage[i1]);
 
-    other = std::move(*this);
+    std::swap(storage, other.storage);
 
-    *this = std::move(temp);
+    std::swap(capacity, other.capacity);
+
+    std::swap(allocator, other.allocator);
+
+    std::swap(number_blocks, other.number_blocks);
+
+    std::swap(bits_used, other.bits_used);
+
+    if(this_local)
+        other.storage = other.local_storage;
+
+    if(other_local)
+        storage = local_storage;
 }
 
 
 // adds the number to the object
 aint& aint::operator+=(const aint& b)
 {
-    *this = (*this + b);
+    if(b.zero())
+        return *this;
 
-    return *this;
-}
+    // adding a number to itself is a shift by one
+    if(this == &b)
+        return *this <<= 1;
 
+    size_t length = number_blocks >= b.number_blocks ? number_blocks : b.number_blocks;
 
-// subtracts the number from the object
-aint& aint::operator-=(const aint& b)
-{
-    *this = (*this - b);
+    // one additional block for the final carry
+    if(capacity <= length)
+        reserve(grow(length));
 
-    return *this;
-}
+    // the kernel expects the longer number first, the result may share the storage of either number
+    block_type carry = number_blocks >= b.number_blocks
+                       ? kernel::add(storage, storage, number_blocks, b.storage, b.number_blocks)
+                       : kernel::add(storage, b.storage, b.number_blocks, storage, number_blocks);
 
+    number_blocks = length;
 
-// multiply the object with the number
-aint& aint::operator*=(const aint& b)
-{
-    *this = (*this * b);
+    // there could be an overflow left
+    if(carry)
+        storage[number_blocks++] = carry;
+
+    bits_used = significant_bits(storage[number_blocks - 1]);
 
     return *this;
 }
 
 
-// divide the object by the number (integer division)
-aint& aint::operator/=(const aint& b)
+// subtracts the number from the object or sets it to 0 if the object <= b
+aint& aint::operator-=(const aint& b)
 {
-    *this = (*this / b);
-
-    return *this;
-}
+    if(b.zero())
+        return *this;
 
+    // instead of negative numbers the object becomes zero but keeps its storage
+    if(kernel::cmp(storage, number_blocks, b.storage, b.number_blocks) <= 0)
+    {
+        number_blocks = 0;
 
-// divide the object by the number and store the remainder in the object
-aint& aint::operator%=(const aint& b)
-{
-    *this = (*this % b);
+        bits_used = 0;
 
-    return *this;
-}
+        return *this;
+    }
 
+    // at this point the object is larger than b so there is no borrow left in the end
+    kernel::sub(storage, storage, number_blocks, b.storage, b.number_blocks);
 
-// shifts the bits in the object by the number from LSB to MSB
-aint& aint::operator<<=(size_t shifts)
-{
-    *this = (*this << shifts);
+    normalize();
 
     return *this;
 }
 
 
-// shifts the bits in the object by the number from MSB to LSB
-aint& aint::operator>>=(size_t shifts)
+// multiply the object with the number
+aint& aint::operator*=(const aint& b)
 {
-    *this = (*this >> shifts);
+    if(zero())
+        return *this;
 
-    return *this;
-}
+    if(b.zero())
+    {
+        number_blocks = 0;
 
+        bits_used = 0;
 
-// private memmber functions
+        return *this;
+    }
 
-void aint::push_back(uint32_t block, size_t counter, bool isvalid)
-{
-    // isvalid indicates whether counter represents the true number of bits used in block
-    if(!isvalid && block)
+    // the in place schoolbook method reads the blocks of b while the object is overwritten, so squares and
+    // products large enough for the divide and conquer methods are computed into new storage
+    if(this == &b || b.number_blocks >= kernel::thresholds.mul_karatsuba)
     {
-        counter = 32;
+        aint product = *this * b;
 
-        while(! (block & (1 << (counter - 1) ) ) )
-            --counter;
+        swap(product);
+
+        return *this;
     }
-    else if(!isvalid)
-        counter = 32;
 
-    bits_used = counter;
+    size_t length = number_blocks + b.number_blocks;
 
-    if(number_blocks == capacity)
-        reserve(static_cast<size_t>(number_blocks * 1.5l) + 1);
+    if(capacity < length)
+        reserve(grow(length));
 
-    storage[number_blocks] = block;
+    for(size_t i1 = number_blocks; i1 < length; ++i1)
+        storage[i1] = 0;
 
-    ++number_blocks;
-}
+    // the schoolbook method starting with the most significant block of the object:
+    // block i1 - 1 is replaced by its products with b which only touch blocks at position i1 - 1 and above,
+    // while the less significant blocks are still waiting to be processed
+    for(size_t i1 = number_blocks; i1 > 0; --i1)
+    {
+        block_type factor = storage[i1 - 1];
 
+        storage[i1 - 1] = 0;
 
-void aint::reserve(size_t new_cap)
-{
-    // it must be ensured that new_cap >= number_blocks
-    // since this functions is private it is the classes responsibility to call it correctly
-    if(!new_cap)
-        return;
+        block_type carry = kernel::addmul_1(storage + i1 - 1, b.storage, b.number_blocks, factor);
 
-    auto temp_storage = new uint32_t[new_cap]{0};
+        // the blocks above already contain partial results of more significant blocks
+        size_t position = i1 - 1 + b.number_blocks;
 
-    for(size_t i1 = 0; i1 < number_blocks; ++i1)
-        temp_storage[i1] = storage[i1];
+        kernel::add_1(storage + position, storage + position, length - position, carry);
+    }
 
-    // release owned resources
-    delete[] storage;
+    number_blocks = length;
 
-    storage = temp_storage;
+    normalize();
 
-    capacity = new_cap;
+    return *this;
 }
 
 
-void aint::shrink()
+// divide the object by the number (integer division)
+aint& aint::operator/=(const aint& b)
 {
-    // releases parts of the owned resources
-    size_t used_blocks = capacity;
-
-    while(used_blocks && !storage[used_blocks - 1])
-        --used_blocks;
-
-    // set the object to zero if the entire storage is empty
-    if(!used_blocks)
+    // division by zero will return zero
+    if(b.zero() || (*this < b))
     {
-        *this = aint{0};
+        number_blocks = 0;
 
-        return;
+        bits_used = 0;
+
+        return *this;
     }
 
-    else
-    {
-        number_blocks = used_blocks;
+    if(this == &b)
+        return *this = 1;
 
-        size_t bits = 32;
+    aint quotient{};
 
-        while( !(storage[number_blocks - 1] & (1<<(bits - 1))))
-            --bits;
+    // the object is reduced to the remainder in place while the quotient is collected
+    divide(b, &quotient);
 
-        bits_used = bits;
-    }
+    return *this = std::move(quotient);
+}
+
+
+// divide the object by the number and store the remainder in the object
+aint& aint::operator%=(const aint& b)
+{
+    // modulo by zero will return the original number
+    if(b.zero() || (*this < b))
+        return *this;
 
-    if(capacity > (number_blocks * 1.5l + 1))
-        reserve(static_cast<size_t>(number_blocks * 1.5l) +1);
+    if(this == &b)
+        return *this -= b;
 
+    divide(b, nullptr);
+
+    return *this;
 }
 
-// non-member functions
 
-// output as bits in reverse order (from LSB to MSB)
-std::ostream& operator<<(std::ostream& out, const aint& num)
+// shifts the bits in the object by the number from LSB to MSB
+aint& aint::operator<<=(size_t shifts)
 {
-    if(num.number_blocks)
-    {
-        // these are the blocks to be printed fully
-        for(size_t i1 = 0; i1 < (num.number_blocks - 1); ++i1)
-        {
-            size_t bit = 0;
+    if(!shifts || zero())
+        return *this;
 
-            while(bit < 32)
-            {
-                (num.storage[i1] & (1<<bit)) ? out << "1" : out << "0";
+    // number of additional empty blocks created by the shift. Those blocks represent the LSBs of the number
+    size_t add_blocks = shifts / block_bits;
 
-                ++bit;
-            }
-        }
+    shifts %= block_bits;
 
-        // now only the bits actually used in the last block are printed
-        size_t bit = 0;
+    // one additional block for the bits pushed out of the most significant block
+    size_t length = number_blocks + add_blocks + 1;
 
-        while(bit < num.bits_used)
-        {
-            num.storage[num.number_blocks-1] & (1<<bit) ? out << "1" : out << "0";
+    if(capacity < length)
+        reserve(grow(length));
+
+    // the kernel works from the most significant block down so it can move the blocks up at the same time
+    if(shifts)
+        storage[length - 1] = kernel::lshift_n(storage + add_blocks, storage, number_blocks, shifts);
 
-            ++bit;
-        }
-    }
     else
     {
-        // a single "0"-bit symbolises that the entire number is equal to zero
-        out << "0";
+        std::memmove(storage + add_blocks, storage, number_blocks * sizeof(block_type));
+
+        storage[length - 1] = 0;
     }
 
-    return out;
-}
+    for(size_t i1 = 0; i1 < add_blocks; ++i1)
+        storage[i1] = 0;
 
+    number_blocks = length;
 
-// input from a stream of 1s and 0s where the order is reversed i.e. LSB to MSB
-std::istream& operator>>(std::istream& in, aint& num)
-{
-    // if the users doesn't enter any valid number at all num shall take the value of zero
-    // the sequence has to end with "1" otherwise there is no guarantee for the correct functionality of aint
+    normalize();
 
-    aint temp{0};
+    return *this;
+}
 
-    uint32_t block = 0;
 
-    size_t counter = 0;
+// shifts the bits in the object by the number from MSB to LSB
+aint& aint::operator>>=(size_t shifts)
+{
+    if(!shifts || zero())
+        return *this;
 
-    // get rid of leading whitespaces
-    while(std::isspace(in.peek()))
-        in.get();
+    // number of blocks that will be cut off entirely by the shift
+    size_t cut_blocks = shifts / block_bits;
 
-    // return type for istream.peek() is int
-    int input = in.peek();
+    shifts %= block_bits;
 
-    while((input == '0') || (input == '1'))
+    // check if the entire number will be cut off
+    if(cut_blocks >= number_blocks || ((cut_blocks + 1 == number_blocks) && (bits_used <= shifts)))
     {
-        if (input == '1')
-        {
-            block |= (1 << counter);
-
-            ++counter;
-        }
-
-        else if (input == '0')
-            ++counter;
+        number_blocks = 0;
 
-        // check if the current block is full
-        if (counter == 32)
-        {
-            temp.push_back(block, counter, true);
+        bits_used = 0;
 
-            block = 0;
+        return *this;
+    }
 
-            counter = 0;
-        }
+    size_t length = number_blocks - cut_blocks;
 
-        in.get();
+    // the kernel works from the least significant block up so it can move the blocks down at the same time
+    if(shifts)
+        kernel::rshift_n(storage, storage + cut_blocks, length, shifts);
 
-        input = in.peek();
-    }
+    else
+        std::memmove(storage, storage + cut_blocks, length * sizeof(block_type));
 
-    // check if a non binary symbol popped up while still filling a block
-    if (block)
-        temp.push_back(block, counter, true);
+    number_blocks = length;
 
-    num = std::move(temp);
+    normalize();
 
-    return in;
+    return *this;
 }
 
 
-/*
-// different solution -> also not working when used like while(std::cin >> aint)
-std::istream& operator>>(std::istream& in, aint& num)
+// add a single word to the object
+aint& aint::operator+=(uint64_t b)
 {
-    aint temp{};
-
-    uint32_t block = 32;
-
-    size_t counter = 0;
+    if(!b)
+        return *this;
 
-    char input = 0;
+    // one additional block for the final carry
+    if(capacity <= number_blocks)
+        reserve(grow(number_blocks));
 
-    while(true)
-    {
-        if(!in.good())
-        {
-            in.setstate(std::ios::failbit);
+    // for a zero object the whole word is the carry
+    block_type carry = kernel::add_1(storage, storage, number_blocks, b);
 
-            return in;
-        }
+    if(carry)
+        storage[number_blocks++] = carry;
 
-        input = static_cast<char>(in.peek());
+    bits_used = significant_bits(storage[number_blocks - 1]);
 
-        if(!std::isspace(input))
-            break;
+    return *this;
+}
 
-        in.get();
-    }
 
-    if(!in.good())
-        return in;
+// subtract a single word from the object
+aint& aint::operator-=(uint64_t b)
+{
+    if(!b)
+        return *this;
 
-    if((input != '0') && (input != '1'))
+    // instead of negative numbers the object becomes zero but keeps its storage
+    if(compare(*this, b) <= 0)
     {
-        in.setstate(std::ios::failbit);
+        number_blocks = 0;
 
-        return in;
+        bits_used = 0;
+
+        return *this;
     }
 
-    input = static_cast<char>(in.peek());
+    kernel::sub_1(storage, storage, number_blocks, b);
 
-    while(in.good() && ((input == '0') || (input == '1')))
-    {
-        if (input == '1')
-            block |= (1 << counter);
+    normalize();
 
-        ++counter;
+    return *this;
+}
 
-        // check if the current block is full
-        if (counter == 32)
-        {
-            temp.push_back(block, counter, true);
 
-            block = 0;
+// multiply the object with a single word
+aint& aint::operator*=(uint64_t b)
+{
+    if(zero())
+        return *this;
 
-            counter = 0;
-        }
+    if(!b)
+    {
+        number_blocks = 0;
 
-        in.get();
+        bits_used = 0;
 
-        input = static_cast<char>(in.peek());
+        return *this;
     }
 
-    // check if terminating symbol popped up while still filling a block
-    if (block)
-        temp.push_back(block, counter, true);
+    if(capacity <= number_blocks)
+        reserve(grow(number_blocks));
 
-    num = std::move(temp);
+    block_type carry = kernel::mul_1(storage, storage, number_blocks, b);
 
-    return in;
-}*/
+    if(carry)
+        storage[number_blocks++] = carry;
 
+    bits_used = significant_bits(storage[number_blocks - 1]);
 
-// check for equal values
-bool operator==(const aint& a, const aint& b)
-{
-    // check separately because in this case accessing storage would result in segmentation fault
-    if(a.zero() && b.zero())
-        return true;
+    return *this;
+}
 
-    // if these values differ the numbers can't be the same
-    else if( (a.number_blocks != b.number_blocks) || (a.bits_used != b.bits_used))
-        return false;
 
-    else
-    {
-        // at this point a.number_blocks == b.number_blocks
-        for(size_t i1 = 0; i1 < a.number_blocks; ++i1)
-        {
-            if(a.storage[i1] != b.storage[i1])
-                return false;
-        }
+// divide the object by a single word, division by zero will return zero
+aint& aint::operator/=(uint64_t b)
+{
+    divmod(*this, b, *this);
 
-        return true;
-    }
+    return *this;
 }
 
 
-// check for unequal values by using the operator for equality
-bool operator!=(const aint& a, const aint& b)
+// replace the object by its remainder of the division by a single word, modulo by zero keeps the number
+aint& aint::operator%=(uint64_t b)
 {
-    return !(a==b);
+    if(b)
+        *this = kernel::mod_1(storage, number_blocks, b);
+
+    return *this;
 }
 
 
-// check if the first number is smaller than the second
-bool operator<(const aint& a, const aint& b)
-{
-    // number a can never be less than zero
-    if(b.zero())
+// private memmber functions
+
+void aint::push_back(block_type block, size_t counter, bool isvalid)
+{
+    // isvalid indicates whether counter represents the true number of bits used in block
+    if(!isvalid && block)
+        counter = significant_bits(block);
+
+    else if(!isvalid)
+        counter = block_bits;
+
+    bits_used = counter;
+
+    if(number_blocks == capacity)
+        reserve(grow(number_blocks));
+
+    storage[number_blocks] = block;
+
+    ++number_blocks;
+}
+
+
+void aint::reserve(size_t new_cap)
+{
+    // it must be ensured that new_cap >= number_blocks
+    // since this functions is private it is the classes responsibility to call it correctly
+    // only the blocks up to number_blocks are preserved, the content of the other blocks is undefined
+    if(new_cap <= inline_blocks)
+    {
+        // small numbers move back into the inline buffer
+        if(storage != local_storage)
+        {
+            for(size_t i1 = 0; i1 < number_blocks; ++i1)
+                local_storage[i1] = storage[i1];
+
+            block_allocator::give_back(storage, capacity, allocator);
+
+            storage = local_storage;
+
+            capacity = inline_blocks;
+
+            allocator = nullptr;
+        }
+
+        return;
+    }
+
+    // the allocator may hand out more blocks than requested
+    block_allocator* temp_allocator = nullptr;
+
+    auto temp_storage = block_allocator::acquire(new_cap, temp_allocator);
+
+    for(size_t i1 = 0; i1 < number_blocks; ++i1)
+        temp_storage[i1] = storage[i1];
+
+    // release owned resources
+    if(storage != local_storage)
+        block_allocator::give_back(storage, capacity, allocator);
+
+    storage = temp_storage;
+
+    capacity = new_cap;
+
+    allocator = temp_allocator;
+}
+
+
+void aint::shrink()
+{
+    // releases parts of the owned resources
+    normalize();
+
+    // set the object to zero if the entire storage is empty
+    if(!number_blocks)
+    {
+        release();
+
+        return;
+    }
+
+    // allocators round requests up (the thread pool to powers of two) so only clearly oversized storage is released
+    if(capacity > 2 * grow(number_blocks))
+        reserve(grow(number_blocks));
+}
+
+
+void aint::release()
+{
+    // frees heap storage and sets the object to zero using the inline buffer
+    if(storage != local_storage)
+        block_allocator::give_back(storage, capacity, allocator);
+
+    storage = local_storage;
+
+    capacity = inline_blocks;
+
+    allocator = nullptr;
+
+    number_blocks = 0;
+
+    bits_used = 0;
+}
+
+
+// number of blocks to reserve for a number of the given size
+size_t aint::grow(size_t blocks)
+{
+    return block_allocator::current_growth()(blocks);
+}
+
+
+// drops leading zero blocks and updates bits_used without touching the storage
+void aint::normalize()
+{
+    while(number_blocks && !storage[number_blocks - 1])
+        --number_blocks;
+
+    bits_used = number_blocks ? significant_bits(storage[number_blocks - 1]) : 0;
+}
+
+
+void aint::add_blocks(const block_type* b, size_t bn, size_t offset)
+{
+    size_t length = number_blocks > offset + bn ? number_blocks : offset + bn;
+
+    // one additional block for the final carry
+    if(capacity <= length)
+        reserve(grow(length));
+
+    // the gap between the object and the shifted blocks is filled with zeros, then the blocks are simply copied
+    if(number_blocks <= offset)
+    {
+        for(size_t i1 = number_blocks; i1 < offset; ++i1)
+            storage[i1] = 0;
+
+        std::memcpy(storage + offset, b, bn * sizeof(block_type));
+
+        number_blocks = length;
+
+        bits_used = significant_bits(storage[number_blocks - 1]);
+
+        return;
+    }
+
+    size_t overlap = number_blocks - offset;
+
+    // the kernel expects the longer number first
+    block_type carry = overlap >= bn ? kernel::add(storage + offset, storage + offset, overlap, b, bn)
+                                     : kernel::add(storage + offset, b, bn, storage + offset, overlap);
+
+    number_blocks = length;
+
+    if(carry)
+        storage[number_blocks++] = carry;
+
+    bits_used = significant_bits(storage[number_blocks - 1]);
+}
+
+
+void aint::sub_blocks(const block_type* b, size_t bn, size_t offset)
+{
+    // below the offset the object has only its own blocks, they decide if the upper blocks are equal
+    int order = number_blocks < offset + bn ? -1
+                : kernel::cmp(storage + offset, number_blocks - offset, b, bn);
+
+    if(order < 0 || (!order && !kernel::normalized_size(storage, offset)))
+    {
+        number_blocks = 0;
+
+        bits_used = 0;
+
+        return;
+    }
+
+    kernel::sub(storage + offset, storage + offset, number_blocks - offset, b, bn);
+
+    normalize();
+}
+
+
+size_t aint::bit_length() const
+{
+    return number_blocks ? (number_blocks - 1) * block_bits + bits_used : 0;
+}
+
+
+// owner of the blocks of views, they belong to someone else and are never released
+class borrowed_blocks final : public block_allocator
+{
+public:
+
+    // never installed, a view is only read
+    uint64_t* allocate(size_t&) override
+    {
+        return nullptr;
+    }
+
+    void deallocate(uint64_t*, size_t) override
+    {
+    }
+};
+
+static borrowed_blocks borrowed_storage;
+
+
+aint::view::view(const aint& other)
+{
+    borrow(other.storage, other.number_blocks);
+}
+
+
+aint::view::view(const uint64_t* blocks, size_t count)
+{
+    borrow(blocks, kernel::normalized_size(blocks, count));
+}
+
+
+aint::view::view(const view& other)
+{
+    borrow(other.number.storage, other.number.number_blocks);
+}
+
+
+aint::view& aint::view::operator=(const view& other)
+{
+    borrow(other.number.storage, other.number.number_blocks);
+
+    return *this;
+}
+
+
+// count has to be normalized, the inline buffer of the view stays unused
+void aint::view::borrow(const uint64_t* blocks, size_t count)
+{
+    if(!count)
+    {
+        number.storage = number.local_storage;
+
+        number.capacity = inline_blocks;
+
+        number.allocator = nullptr;
+
+        number.number_blocks = 0;
+
+        number.bits_used = 0;
+
+        return;
+    }
+
+    // the number is only handed out as const, so the blocks are never written
+    number.storage = const_cast<block_type*>(blocks);
+
+    number.capacity = count;
+
+    number.allocator = &borrowed_storage;
+
+    number.number_blocks = count;
+
+    number.bits_used = significant_bits(blocks[count - 1]);
+}
+
+
+aint::view aint::view::low(size_t k) const
+{
+    return view{number.storage, k < number.number_blocks ? k : number.number_blocks};
+}
+
+
+aint::view aint::view::high(size_t k) const
+{
+    view result{*this};
+
+    // the upper blocks of a normalized number are normalized
+    if(k < number.number_blocks)
+        result.borrow(number.storage + k, number.number_blocks - k);
+
+    else
+        result.borrow(nullptr, 0);
+
+    return result;
+}
+
+
+aint::view aint::view::top(size_t k) const
+{
+    return high(k < number.number_blocks ? number.number_blocks - k : 0);
+}
+
+
+int aint::compare(const aint& a, uint64_t b)
+{
+    if(a.number_blocks > 1)
+        return 1;
+
+    block_type value = a.number_blocks ? a.storage[0] : 0;
+
+    return value < b ? -1 : (value > b ? 1 : 0);
+}
+
+
+void aint::prepare_quotient(const aint& dividend)
+{
+    if(this == &dividend)
+        return;
+
+    number_blocks = 0;
+
+    if(capacity < dividend.number_blocks)
+        reserve(dividend.number_blocks);
+}
+
+
+// long division which reduces the object to the remainder in place, requires *this >= b > 0 and b not being the object
+// the quotient is only collected if a target for it is given, otherwise it goes to scratch storage
+void aint::divide(const aint& b, aint* quotient)
+{
+    // one block more than the quotient can have, the division works on the dividend extended by one block
+    size_t quotient_blocks = number_blocks - b.number_blocks + 2;
+
+    if(!quotient)
+    {
+        if(b.number_blocks == 1)
+        {
+            storage[0] = kernel::mod_1(storage, number_blocks, b.storage[0]);
+
+            number_blocks = 1;
+
+            normalize();
+
+            return;
+        }
+
+        kernel::scratch discarded{quotient_blocks};
+
+        divide_blocks(b, discarded.get());
+
+        return;
+    }
+
+    // the storage of the quotient is reused if it is large enough
+    quotient->number_blocks = 0;
+
+    if(quotient->capacity < quotient_blocks)
+        quotient->reserve(quotient_blocks);
+
+    if(b.number_blocks == 1)
+    {
+        storage[0] = kernel::divrem_1(quotient->storage, storage, number_blocks, b.storage[0]);
+
+        quotient->number_blocks = number_blocks;
+
+        number_blocks = 1;
+
+        normalize();
+
+        quotient->normalize();
+
+        return;
+    }
+
+    divide_blocks(b, quotient->storage);
+
+    quotient->number_blocks = quotient_blocks - 1;
+
+    quotient->normalize();
+}
+
+
+// the division of divide() by a divisor of at least two blocks
+// q receives the quotient and needs number_blocks - b.number_blocks + 2 blocks
+void aint::divide_blocks(const aint& b, block_type* q)
+{
+    // both numbers are shifted until the most significant bit of the divisor is set
+    size_t shift = block_bits - b.bits_used;
+
+    if(capacity < number_blocks + 1)
+        reserve(grow(number_blocks + 1));
+
+    storage[number_blocks] = shift ? kernel::lshift_n(storage, storage, number_blocks, shift) : 0;
+
+    kernel::scratch normalized{shift ? b.number_blocks : 0};
+
+    const block_type* divisor = b.storage;
+
+    if(shift)
+    {
+        kernel::lshift_n(normalized.get(), b.storage, b.number_blocks, shift);
+
+        divisor = normalized.get();
+    }
+
+    // the extended dividend starts with a block smaller than the one of the divisor, so the quotient fits into
+    // number_blocks + 1 - b.number_blocks blocks and the returned top block is always 0
+    kernel::div_qr(q, storage, number_blocks + 1, divisor, b.number_blocks);
+
+    number_blocks = b.number_blocks;
+
+    if(shift)
+        kernel::rshift_n(storage, storage, number_blocks, shift);
+
+    normalize();
+}
+
+
+// non-member functions
+
+// the characters of the 8 bits of every byte in output order, i.e. from LSB to MSB
+static const auto byte_chars = []()
+{
+    std::array<std::array<char, 8>, 256> table{};
+
+    for(size_t i1 = 0; i1 < 256; ++i1)
+    {
+        for(size_t i2 = 0; i2 < 8; ++i2)
+            table[i1][i2] = (i1 >> i2) & 1 ? '1' : '0';
+    }
+
+    return table;
+}();
+
+
+// bits in reverse order (from LSB to MSB), every byte of a block is expanded to 8 characters at once by the table
+std::to_chars_result to_chars(char* first, char* last, const aint& num)
+{
+    // a single "0"-bit symbolises that the entire number is equal to zero
+    size_t length = num.number_blocks ? num.bit_length() : 1;
+
+    if(static_cast<size_t>(last - first) < length)
+        return {last, std::errc::value_too_large};
+
+    if(!num.number_blocks)
+    {
+        *first = '0';
+
+        return {first + 1, std::errc{}};
+    }
+
+    char* position = first;
+
+    for(size_t i1 = 0; i1 < num.number_blocks; ++i1)
+    {
+        aint::block_type block = num.storage[i1];
+
+        // only the bits actually used in the last block are printed
+        size_t bits = i1 + 1 < num.number_blocks ? aint::block_bits : num.bits_used;
+
+        for(; bits >= 8; bits -= 8)
+        {
+            std::memcpy(position, byte_chars[block & 0xFF].data(), 8);
+
+            position += 8;
+
+            block >>= 8;
+        }
+
+        std::memcpy(position, byte_chars[block & 0xFF].data(), bits);
+
+        position += bits;
+    }
+
+    return {position, std::errc{}};
+}
+
+
+// the base of the text format chosen for a stream by aint_dec and aint_hex, 0 for the binary format
+static long& text_base(std::ios_base& stream)
+{
+    static const int index = std::ios_base::xalloc();
+
+    return stream.iword(index);
+}
+
+
+std::ios_base& aint_bin(std::ios_base& stream)
+{
+    text_base(stream) = 0;
+
+    return stream;
+}
+
+
+std::ios_base& aint_dec(std::ios_base& stream)
+{
+    text_base(stream) = 10;
+
+    return stream;
+}
+
+
+std::ios_base& aint_hex(std::ios_base& stream)
+{
+    text_base(stream) = 16;
+
+    return stream;
+}
+
+
+// output as bits in reverse order (from LSB to MSB), the characters are collected in one buffer and written at once
+// after aint_dec or aint_hex the number is written in that base instead (see aint_radix.cpp)
+std::ostream& operator<<(std::ostream& out, const aint& num)
+{
+    if(text_base(out))
+    {
+        std::string text = to_string(num, static_cast<unsigned>(text_base(out)));
+
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+
+        return out;
+    }
+
+    size_t length = num.number_blocks ? num.bit_length() : 1;
+
+    // small numbers do not need the heap
+    char local_text[4 * aint::inline_blocks * aint::block_bits];
+
+    std::unique_ptr<char[]> heap_text{length > sizeof(local_text) ? new char[length] : nullptr};
+
+    char* text = heap_text ? heap_text.get() : local_text;
+
+    to_chars(text, text + length, num);
+
+    out.write(text, static_cast<std::streamsize>(length));
+
+    return out;
+}
+
+
+// access to the characters buffered by a stream, std::streambuf only offers it to derived classes but a pointer to
+// the member formed in a derived class can be used with any stream buffer
+struct get_area : std::streambuf
+{
+    static const char* begin(std::streambuf* buffer)
+    {
+        return (buffer->*&get_area::gptr)();
+    }
+
+    static const char* end(std::streambuf* buffer)
+    {
+        return (buffer->*&get_area::egptr)();
+    }
+
+    static void consume(std::streambuf* buffer, size_t count)
+    {
+        (buffer->*&get_area::gbump)(static_cast<int>(count));
+    }
+};
+
+
+#if defined(__AVX2__)
+constexpr size_t parse_width = 32;
+#elif defined(__SSE2__)
+constexpr size_t parse_width = 16;
+#else
+constexpr size_t parse_width = 8;
+#endif
+
+
+// classifies parse_width characters at once, returns the number of leading '0' and '1' and sets the bits of the '1'
+// among them, bit i belongs to the character at position i which matches the order of the input
+static size_t parse_digits(const char* text, uint32_t& ones)
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+#if defined(__AVX2__)
+    __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text));
+
+    auto one = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('1'))));
+
+    auto zero = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('0'))));
+#else
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+
+    auto one = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('1'))));
+
+    auto zero = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('0'))));
+#endif
+
+    uint32_t digits = one | zero;
+
+    // the first character which is not a digit ends the number
+    size_t count = ~digits ? static_cast<size_t>(__builtin_ctz(~digits)) : 32;
+
+    if(count > parse_width)
+        count = parse_width;
+
+    ones = count < 32 ? one & ((uint32_t{1} << count) - 1) : one;
+
+    return count;
+#else
+    ones = 0;
+
+    for(size_t i1 = 0; i1 < parse_width; ++i1)
+    {
+        if(text[i1] != '0' && text[i1] != '1')
+            return i1;
+
+        ones |= static_cast<uint32_t>(text[i1] == '1') << i1;
+    }
+
+    return parse_width;
+#endif
+}
+
+
+// input from a stream of 1s and 0s where the order is reversed i.e. LSB to MSB
+// the characters are taken directly from the buffer of the stream, parse_width of them at a time
+std::istream& operator>>(std::istream& in, aint& num)
+{
+    // the sentry skips leading whitespace and fails at the end of the input
+    std::istream::sentry guard(in);
+
+    std::streambuf* buffer = in.rdbuf();
+
+    // return type for sgetc() is int
+    int input = guard ? buffer->sgetc() : std::char_traits<char>::eof();
+
+    // after aint_dec or aint_hex the digits are collected and converted at once (see aint_radix.cpp)
+    if(text_base(in))
+    {
+        auto base = static_cast<unsigned>(text_base(in));
+
+        std::string text;
+
+        while(input != std::char_traits<char>::eof())
+        {
+            if(base == 16 ? !std::isxdigit(input) : !std::isdigit(input))
+                break;
+
+            text.push_back(std::char_traits<char>::to_char_type(input));
+
+            buffer->sbumpc();
+
+            input = buffer->sgetc();
+        }
+
+        num = from_string(text, base);
+
+        if(text.empty())
+            in.setstate(std::ios::failbit);
+
+        if(input == std::char_traits<char>::eof())
+            in.setstate(std::ios::eofbit);
+
+        return in;
+    }
+
+    // if the users doesn't enter any valid number at all num shall take the value of zero and the stream fails
+    if((input != '0') && (input != '1'))
+    {
+        num = 0;
+
+        in.setstate(input == std::char_traits<char>::eof() ? std::ios::failbit | std::ios::eofbit : std::ios::failbit);
+
+        return in;
+    }
+
+    aint temp{0};
+
+    aint::block_type block = 0;
+
+    size_t counter = 0;
+
+    // appends the lowest count <= 32 bits of bits to the number
+    auto append = [&](aint::block_type bits, size_t count)
+    {
+        block |= bits << counter;
+
+        counter += count;
+
+        // check if the current block is full
+        if(counter >= aint::block_bits)
+        {
+            temp.push_back(block, aint::block_bits, true);
+
+            counter -= aint::block_bits;
+
+            // counter > 32 before the block was full, so the shift is smaller than 32
+            block = counter ? bits >> (count - counter) : 0;
+        }
+    };
+
+    while((input == '0') || (input == '1'))
+    {
+        const char* position = get_area::begin(buffer);
+
+        const char* end = get_area::end(buffer);
+
+        // unbuffered streams and the last few characters of the buffer are read one by one
+        if(end - position < static_cast<std::ptrdiff_t>(parse_width))
+        {
+            append(input == '1', 1);
+
+            buffer->sbumpc();
+
+            input = buffer->sgetc();
+
+            continue;
+        }
+
+        size_t digits = parse_width;
+
+        while(digits == parse_width && end - position >= static_cast<std::ptrdiff_t>(parse_width))
+        {
+            uint32_t ones;
+
+            digits = parse_digits(position, ones);
+
+            append(ones, digits);
+
+            position += digits;
+        }
+
+        get_area::consume(buffer, static_cast<size_t>(position - get_area::begin(buffer)));
+
+        input = buffer->sgetc();
+    }
+
+    // like the extractors of the built-in types the end of the input sets eofbit but not failbit
+    if(input == std::char_traits<char>::eof())
+        in.setstate(std::ios::eofbit);
+
+    // check if a non binary symbol popped up while still filling a block
+    if (block)
+        temp.push_back(block, counter, true);
+
+    // trailing zeros, i.e. leading zeros of the number, must not count as used bits
+    temp.normalize();
+
+    num = std::move(temp);
+
+    return in;
+}
+
+
+// check for equal values
+bool operator==(const aint& a, const aint& b)
+{
+    // if these values differ the numbers can't be the same
+    if( (a.number_blocks != b.number_blocks) || (a.bits_used != b.bits_used))
         return false;
 
-    else if(a.number_blocks < b.number_blocks)
-        return true;
+    // at this point a.number_blocks == b.number_blocks
+    return kernel::cmp_n(a.storage, b.storage, a.number_blocks) == 0;
+}
+
+
+// check for unequal values by using the operator for equality
+bool operator!=(const aint& a, const aint& b)
+{
+    return !(a==b);
+}
+
+
+// check if the first number is smaller than the second
+bool operator<(const aint& a, const aint& b)
+{
+    // numbers with less blocks are smaller, otherwise the most significant differing block decides
+    return kernel::cmp(a.storage, a.number_blocks, b.storage, b.number_blocks) < 0;
+}
+
+
+// check if the first number is smaller or equal than the second number using corresponding operators
+bool operator<=(const aint& a, const aint& b)
+{
+    return kernel::cmp(a.storage, a.number_blocks, b.storage, b.number_blocks) <= 0;
+}
+
+
+// check if the first number is larger than the second number using the <= operator
+bool operator>(const aint& a, const aint& b)
+{
+    return !(a<=b);
+}
+
+
+// check if the first number is larger or equal to the second number
+bool operator>=(const aint& a, const aint& b)
+{
+    return !(a<b);
+}
+
+// comparisons with a single word
+bool operator==(const aint& a, uint64_t b)
+{
+    return aint::compare(a, b) == 0;
+}
+
+
+bool operator==(uint64_t a, const aint& b)
+{
+    return aint::compare(b, a) == 0;
+}
+
+
+bool operator!=(const aint& a, uint64_t b)
+{
+    return aint::compare(a, b) != 0;
+}
+
+
+bool operator!=(uint64_t a, const aint& b)
+{
+    return aint::compare(b, a) != 0;
+}
+
+
+bool operator<(const aint& a, uint64_t b)
+{
+    return aint::compare(a, b) < 0;
+}
+
+
+bool operator<(uint64_t a, const aint& b)
+{
+    return aint::compare(b, a) > 0;
+}
+
+
+bool operator<=(const aint& a, uint64_t b)
+{
+    return aint::compare(a, b) <= 0;
+}
+
+
+bool operator<=(uint64_t a, const aint& b)
+{
+    return aint::compare(b, a) >= 0;
+}
+
+
+bool operator>(const aint& a, uint64_t b)
+{
+    return aint::compare(a, b) > 0;
+}
+
+
+bool operator>(uint64_t a, const aint& b)
+{
+    return aint::compare(b, a) < 0;
+}
+
+
+bool operator>=(const aint& a, uint64_t b)
+{
+    return aint::compare(a, b) >= 0;
+}
+
+
+bool operator>=(uint64_t a, const aint& b)
+{
+    return aint::compare(b, a) <= 0;
+}
+
+
+// add the numbers together into a new aint object
+aint operator+(const aint& a, const aint& b)
+{
+    if(a.zero())
+        return b;
+
+    else if(b.zero())
+        return a;
+
+    const aint& longer = a.number_blocks >= b.number_blocks ? a : b;
+
+    const aint& shorter = a.number_blocks >= b.number_blocks ? b : a;
+
+    aint result{};
+
+    // reserve enough memory to store addition result and have some extra space
+    result.reserve(aint::grow(longer.number_blocks));
+
+    aint::block_type carry = kernel::add(result.storage, longer.storage, longer.number_blocks,
+                                         shorter.storage, shorter.number_blocks);
+
+    result.number_blocks = longer.number_blocks;
+
+    // there could be an overflow left
+    if(carry)
+        result.storage[result.number_blocks++] = carry;
+
+    result.bits_used = significant_bits(result.storage[result.number_blocks - 1]);
+
+    return result;
+}
+
+
+// subtract b from a or return 0 if a <= b
+aint operator-(const aint& a, const aint& b)
+{
+    // instead of negative numbers zero shall be returned
+    if(a.zero() || b.zero())
+        return a;
+
+    else if(a <= b)
+        return aint{};
 
-    else if(a.number_blocks > b.number_blocks)
-        return false;
+    aint result{};
 
-    else if((a.number_blocks == b.number_blocks) && (a.bits_used < b.bits_used))
-        return true;
+    result.reserve(aint::grow(a.number_blocks));
 
-    else if((a.number_blocks == b.number_blocks) && (a.bits_used > b.bits_used))
-        return false;
+    // a single pass propagating the borrow, there is none left in the end since a > b
+    kernel::sub(result.storage, a.storage, a.number_blocks, b.storage, b.number_blocks);
 
-    else
-        // at this point a.number_blocks == b.number_blocks
-        for(size_t i1 = a.number_blocks; i1 > 0; --i1)
-        {
-            if(a.storage[i1-1] < b.storage[i1-1])
-                return true;
-        }
+    result.number_blocks = a.number_blocks;
 
-        return false;
+    result.normalize();
+
+    return result;
 }
 
 
-// check if the first number is smaller or equal than the second number using corresponding operators
-bool operator<=(const aint& a, const aint& b)
+// multiply two numbers together
+aint operator*(const aint& a, const aint& b)
 {
-    return ( (a==b) || (a<b));
-}
+    if(&a == &b)
+        return square(a);
 
+    if(a.zero() || b.zero())
+        return aint{0};
 
-// check if the first number is larger than the second number using the <= operator
-bool operator>(const aint& a, const aint& b)
-{
-    return !(a<=b);
-}
+    const aint& longer = a.number_blocks >= b.number_blocks ? a : b;
 
+    const aint& shorter = a.number_blocks >= b.number_blocks ? b : a;
 
-// check if the first number is larger or equal to the second number
-bool operator>=(const aint& a, const aint& b)
-{
-    return !(a<b);
+    aint result{};
+
+    // reserve enough memory to store multiplication result and have some extra space
+    result.reserve(aint::grow(a.number_blocks + b.number_blocks));
+
+    kernel::mul(result.storage, longer.storage, longer.number_blocks, shorter.storage, shorter.number_blocks);
+
+    // the product has either exactly as many blocks as both factors together or one less
+    result.number_blocks = a.number_blocks + b.number_blocks;
+
+    result.normalize();
+
+    return result;
 }
 
 
-// add the numbers together into a new aint object
-aint operator+(const aint& a, const aint& b)
+// multiply a number with itself
+aint square(const aint& a)
 {
     if(a.zero())
-        return b;
-
-    else if(b.zero())
-        return a;
+        return aint{0};
 
     aint result{};
 
-    // reserve enough memory to store addition result and have some extra space
-    result.reserve( a.number_blocks >= b.number_blocks
-                    ? static_cast<size_t>(a.number_blocks * 1.5l) + 1
-                    : static_cast<size_t>(b.number_blocks * 1.5l) + 1);
+    result.reserve(aint::grow(2 * a.number_blocks));
 
-    uint64_t add_res = 0;
+    kernel::sqr(result.storage, a.storage, a.number_blocks);
 
-    uint64_t overflow = 0;
+    result.number_blocks = 2 * a.number_blocks;
 
-    for(size_t i1 = 0; i1 < a.number_blocks || i1 < b.number_blocks; ++i1)
-    {
-        if(i1 < a.number_blocks)
-            add_res += a.storage[i1];
+    result.normalize();
+
+    return result;
+}
 
-        if(i1 < b.number_blocks)
-            add_res += b.storage[i1];
 
-        overflow = add_res >>32;
+// product written into the storage of r
+void mul(aint& r, const aint& a, const aint& b)
+{
+    if(a.zero() || b.zero())
+    {
+        r = 0;
+
+        return;
+    }
 
-        // intended cropping when casting to uint32_t
-        // overflow signals to push_back whether the counter is actually valid
-        result.push_back(static_cast<uint32_t>(add_res), 32, static_cast<bool>(overflow));
+    // the kernels must not write into their operands
+    if(&r == &a || &r == &b)
+    {
+        r *= &r == &a ? b : a;
 
-        add_res = overflow;
+        return;
     }
 
-    // there could be an overflow left
-    if(add_res)
-        result.push_back(static_cast<uint32_t>(add_res), 32, false);
+    const aint& longer = a.number_blocks >= b.number_blocks ? a : b;
 
-    return result;
+    const aint& shorter = a.number_blocks >= b.number_blocks ? b : a;
+
+    size_t length = a.number_blocks + b.number_blocks;
+
+    // the old value is not needed, so nothing is copied if the storage has to grow
+    r.number_blocks = 0;
+
+    if(r.capacity < length)
+        r.reserve(aint::grow(length));
+
+    if(&a == &b)
+        kernel::sqr(r.storage, a.storage, a.number_blocks);
+
+    else
+        kernel::mul(r.storage, longer.storage, longer.number_blocks, shorter.storage, shorter.number_blocks);
+
+    r.number_blocks = length;
+
+    r.normalize();
 }
 
 
-// subtract b from a or return 0 if a <= b
-aint operator-(const aint& a, const aint& b)
+// the product is formed in scratch storage and added to r in one pass
+void addmul(aint& r, const aint& a, const aint& b)
 {
-    // instead of negative numbers zero shall be returned
     if(a.zero() || b.zero())
-        return a;
+        return;
 
-    else if(a <= b)
-        return aint{};
+    if(b.number_blocks == 1)
+        return addmul(r, a, b.storage[0]);
 
-    // create a copy of a which will later also store the result of
-    aint result {a};
+    if(a.number_blocks == 1)
+        return addmul(r, b, a.storage[0]);
 
-    // create the twos complement of b and use the add operator to add it to a
-    aint neg{};
+    const aint& longer = a.number_blocks >= b.number_blocks ? a : b;
 
-    neg.reserve(a.number_blocks + 1);
+    const aint& shorter = a.number_blocks >= b.number_blocks ? b : a;
 
-    // twos complement of b needs to have exactly the same length as a
-    for(size_t i1 = 0; i1 < a.number_blocks; ++i1)
-    {
-        // use negated block from b....
-        if(i1 < b.number_blocks)
-            neg.push_back(~b.storage[i1], 32, true);
+    size_t length = a.number_blocks + b.number_blocks;
 
-        // ...or use negated empty block to fill up to the same length
-        else
-            neg.push_back(~static_cast<uint32_t>(0), 32, true);
-    }
+    kernel::scratch product{length};
 
-    neg += aint{1};
+    if(&a == &b)
+        kernel::sqr(product.get(), a.storage, a.number_blocks);
 
-    // add result and neg together
-    uint64_t add_res = 0;
+    else
+        kernel::mul(product.get(), longer.storage, longer.number_blocks, shorter.storage, shorter.number_blocks);
 
-    for(size_t i1 = 0; i1 < result.number_blocks; ++i1)
-    {
-        add_res += result.storage[i1];
+    r.add_blocks(product.get(), kernel::normalized_size(product.get(), length), 0);
+}
 
-        add_res += neg.storage[i1];
 
-        result.storage[i1] = static_cast<uint32_t>(add_res);
+// the products with the single word are added block by block without any temporary
+void addmul(aint& r, const aint& a, uint64_t b)
+{
+    if(a.zero() || !b)
+        return;
 
-        add_res >>=32;
-    }
+    size_t length = r.number_blocks > a.number_blocks ? r.number_blocks : a.number_blocks;
 
-    // there will be some overflow left in add_res in the end which must be set to zero for shrink() to work
-    for(size_t i1 = result.number_blocks; i1 < result.capacity; ++i1)
-        result.storage[i1] = 0;
+    // one additional block for the final carry, a.storage is read afterwards in case r is a
+    if(r.capacity <= length)
+        r.reserve(aint::grow(length));
 
-    result.shrink();
+    for(size_t i1 = r.number_blocks; i1 < a.number_blocks; ++i1)
+        r.storage[i1] = 0;
 
-    return result;
+    aint::block_type carry = kernel::addmul_1(r.storage, a.storage, a.number_blocks, b);
+
+    if(length > a.number_blocks)
+        carry = kernel::add_1(r.storage + a.number_blocks, r.storage + a.number_blocks, length - a.number_blocks,
+                              carry);
+
+    r.number_blocks = length;
+
+    if(carry)
+        r.storage[r.number_blocks++] = carry;
+
+    r.bits_used = significant_bits(r.storage[r.number_blocks - 1]);
 }
 
 
-// multiply two numbers together
-aint operator*(const aint& a, const aint& b)
+void submul(aint& r, const aint& a, const aint& b)
 {
     if(a.zero() || b.zero())
-        return aint{0};
+        return;
 
-    aint result{};
+    if(b.number_blocks == 1)
+        return submul(r, a, b.storage[0]);
 
-    // reserve enough memory to store multiplication result and have some extra space
-    result.reserve(static_cast<size_t>((a.number_blocks + b.number_blocks) * 1.5l) +1);
+    if(a.number_blocks == 1)
+        return submul(r, b, a.storage[0]);
 
-    uint64_t mult_res = 0;
+    const aint& longer = a.number_blocks >= b.number_blocks ? a : b;
 
-    for(size_t i1 = 0; i1 < b.number_blocks; ++i1)
+    const aint& shorter = a.number_blocks >= b.number_blocks ? b : a;
+
+    size_t length = a.number_blocks + b.number_blocks;
+
+    kernel::scratch product{length};
+
+    if(&a == &b)
+        kernel::sqr(product.get(), a.storage, a.number_blocks);
+
+    else
+        kernel::mul(product.get(), longer.storage, longer.number_blocks, shorter.storage, shorter.number_blocks);
+
+    r.sub_blocks(product.get(), kernel::normalized_size(product.get(), length), 0);
+}
+
+
+// the products are subtracted block by block, a borrow left at the end means r was not larger
+void submul(aint& r, const aint& a, uint64_t b)
+{
+    if(a.zero() || !b)
+        return;
+
+    aint::block_type borrow = 1;
+
+    if(r.number_blocks >= a.number_blocks)
     {
-        for(size_t i2 = 0; i2 < a.number_blocks; ++i2)
-        {
-            mult_res = a.storage[i2] * b.storage[i1];
+        borrow = kernel::submul_1(r.storage, a.storage, a.number_blocks, b);
+
+        if(r.number_blocks > a.number_blocks)
+            borrow = kernel::sub_1(r.storage + a.number_blocks, r.storage + a.number_blocks,
+                                   r.number_blocks - a.number_blocks, borrow);
+    }
 
-            // write the potential overflow to the correct position in result
-            for(size_t i3 = i1 + i2; mult_res > 0; ++i3)
-            {
-                mult_res += result.storage[i3];
+    if(borrow)
+    {
+        r.number_blocks = 0;
 
-                // intended cropping when converting to uint32_t
-                result.storage[i3] = static_cast<uint32_t>(mult_res);
+        r.bits_used = 0;
 
-                mult_res >>= 32;
-            }
-        }
+        return;
     }
-    // adjust number_blocks and bits_used for result without calling shrink() since this might move all the values
 
-    size_t used_blocks = a.number_blocks + b.number_blocks;
+    r.normalize();
+}
 
-    while(!result.storage[used_blocks -1])
-        --used_blocks;
 
-    result.number_blocks = used_blocks;
+// the bits within a block are shifted in scratch storage, whole blocks only move the position where a is added
+void add_shifted(aint& r, const aint& a, size_t shifts)
+{
+    if(a.zero())
+        return;
 
-    size_t bits = 32;
+    size_t offset = shifts / aint::block_bits;
 
-    while(!(result.storage[result.number_blocks -1] & (1 <<(bits-1))))
-        --bits;
+    shifts %= aint::block_bits;
 
-    result.bits_used = bits;
+    if(!shifts && &r != &a)
+        return r.add_blocks(a.storage, a.number_blocks, offset);
 
-    return result;
+    kernel::scratch shifted{a.number_blocks + 1};
+
+    if(shifts)
+        shifted.get()[a.number_blocks] = kernel::lshift_n(shifted.get(), a.storage, a.number_blocks, shifts);
+
+    else
+        std::memcpy(shifted.get(), a.storage, a.number_blocks * sizeof(aint::block_type));
+
+    r.add_blocks(shifted.get(), kernel::normalized_size(shifted.get(), a.number_blocks + (shifts ? 1 : 0)), offset);
+}
+
+
+void sub_shifted(aint& r, const aint& a, size_t shifts)
+{
+    if(a.zero())
+        return;
+
+    size_t offset = shifts / aint::block_bits;
+
+    shifts %= aint::block_bits;
+
+    if(!shifts && &r != &a)
+        return r.sub_blocks(a.storage, a.number_blocks, offset);
+
+    kernel::scratch shifted{a.number_blocks + 1};
+
+    if(shifts)
+        shifted.get()[a.number_blocks] = kernel::lshift_n(shifted.get(), a.storage, a.number_blocks, shifts);
+
+    else
+        std::memcpy(shifted.get(), a.storage, a.number_blocks * sizeof(aint::block_type));
+
+    r.sub_blocks(shifted.get(), kernel::normalized_size(shifted.get(), a.number_blocks + (shifts ? 1 : 0)), offset);
 }
 
 
 // divide the first number by the second number (integer division)
 aint operator/(const aint& a, const aint& b)
 {
-    // division by zero will return zero
-    if (b.zero() || (a < b))
-        return aint{};
+    aint quotient{};
 
-    if(b == aint{1})
-        return a;
+    aint remainder{};
 
-    aint quotient{};
+    divmod(a, b, quotient, remainder);
 
-    // since the quotient can never be larger than the original number memory reservation can be done more conservative
-    quotient.reserve(a.number_blocks + 1);
+    return quotient;
+}
+
+
+//  return the remainder of dividing the first number by the second number
+aint operator%(const aint& a, const aint& b)
+{
+    aint quotient{};
 
     aint remainder{};
 
-    for(size_t i1 = a.number_blocks; i1 > 0; --i1)
-    {
-        size_t used_bits = (i1 == a.number_blocks)
-                            ? a.bits_used
-                            : 32;
+    divmod(a, b, quotient, remainder);
 
-        for(size_t i2 = used_bits; i2 > 0; --i2)
-        {
-            uint32_t  bit = (a.storage[i1-1] & (1 << (i2-1)));
+    // remainder might be very small and requires less memory
+    remainder.shrink();
+
+    return remainder;
+}
+
+// arithmetic with a single word, the copy of the number is changed in place
+aint operator+(const aint& a, uint64_t b)
+{
+    aint result{a};
 
-            if(!remainder.zero())
-                remainder <<= 1;
+    result += b;
 
-            if(remainder.zero() && bit)
-                remainder = aint{1};
+    return result;
+}
 
-            else if(bit)
-                remainder.storage[0] |= 1;
 
-            if(remainder >= b)
-            {
-                remainder -= b;
+aint operator+(uint64_t a, const aint& b)
+{
+    return b + a;
+}
 
-                quotient.storage[i1-1] |= (1 << (i2-1));
-            }
-        }
 
-    }
+aint operator-(const aint& a, uint64_t b)
+{
+    aint result{a};
 
-    // quotient might be very small and requires less memory
-    quotient.shrink();
+    result -= b;
 
-    return quotient;
+    return result;
 }
 
 
-//  return the remainder of dividing the first number by the second number
-aint operator%(const aint& a, const aint& b)
+aint operator*(const aint& a, uint64_t b)
 {
-    // modulo by zero will return the original number
-    if (b.zero() || (a < b))
-        return a;
+    aint result{a};
 
-    if((b == aint{1}) || (a == b))
-        return aint{};
+    result *= b;
+
+    return result;
+}
+
+
+aint operator*(uint64_t a, const aint& b)
+{
+    return b * a;
+}
 
+
+aint operator/(const aint& a, uint64_t b)
+{
     aint quotient{};
 
-    // since the quotient can never be larger than the original number memory reservation can be done more conservative
-    quotient.reserve(a.number_blocks + 1);
+    divmod(a, b, quotient);
+
+    return quotient;
+}
+
+
+aint operator%(const aint& a, uint64_t b)
+{
+    // the remainder always fits into the inline buffer
+    return b ? aint{kernel::mod_1(a.storage, a.number_blocks, b)} : a;
+}
 
-    aint remainder{};
 
-    for(size_t i1 = a.number_blocks; i1 > 0; --i1)
+// quotient and remainder of a single division
+std::pair<aint, aint> divmod(const aint& a, const aint& b)
+{
+    std::pair<aint, aint> result{};
+
+    divmod(a, b, result.first, result.second);
+
+    return result;
+}
+
+
+// quotient and remainder of a single division written into existing numbers whose storage is reused
+void divmod(const aint& a, const aint& b, aint& quotient, aint& remainder)
+{
+    // the divisor is read until the very end of the division so it must not be overwritten by a result
+    if(&b == &quotient || &b == &remainder)
     {
-        size_t used_bits = (i1 == a.number_blocks)
-                            ? a.bits_used
-                            : 32;
+        aint divisor{b};
 
-        for(size_t i2 = used_bits; i2 > 0; --i2)
-        {
-            uint32_t  bit = (a.storage[i1-1] & (1 << (i2-1)));
+        divmod(a, divisor, quotient, remainder);
 
-            if(!remainder.zero())
-                remainder <<= 1;
+        return;
+    }
 
-            if(remainder.zero() && bit)
-                remainder = aint{1};
+    remainder = a;
 
-            else if(bit)
-                remainder.storage[0] |= 1;
+    // division by zero yields zero and the original number as remainder like operator/ and operator%
+    if(b.zero() || a < b)
+    {
+        quotient = 0;
 
-            if(remainder >= b)
-            {
-                remainder -= b;
+        return;
+    }
 
-                quotient.storage[i1-1] |= (1 << (i2-1));
-            }
-        }
+    remainder.divide(b, &quotient);
+}
 
+
+// quotient and remainder of a division by a single word
+std::pair<aint, uint64_t> divmod(const aint& a, uint64_t b)
+{
+    std::pair<aint, uint64_t> result{};
+
+    result.second = divmod(a, b, result.first);
+
+    return result;
+}
+
+
+// quotient of a division by a single word written into an existing number, returns the remainder
+uint64_t divmod(const aint& a, uint64_t b, aint& quotient)
+{
+    if(!b)
+    {
+        quotient = 0;
+
+        return 0;
     }
 
-    // remainder might be very small and requires less memory
-    remainder.shrink();
+    quotient.prepare_quotient(a);
+
+    uint64_t remainder = kernel::divrem_1(quotient.storage, a.storage, a.number_blocks, b);
+
+    quotient.number_blocks = a.number_blocks;
+
+    quotient.normalize();
+
+    return remainder;
+}
+
+
+// the same with a precomputed reciprocal of the divisor
+uint64_t divmod(const aint& a, const kernel::limb_divisor& b, aint& quotient)
+{
+    if(!b.value)
+    {
+        quotient = 0;
+
+        return 0;
+    }
+
+    quotient.prepare_quotient(a);
+
+    uint64_t remainder = kernel::divrem_1_preinv(quotient.storage, a.storage, a.number_blocks, b);
+
+    quotient.number_blocks = a.number_blocks;
+
+    quotient.normalize();
 
     return remainder;
 }
@@ -897,41 +1984,38 @@ aint operator<<(const aint& num, size_t shifts)
     aint result{};
 
     // number of additional empty blocks created by the shift. Those blocks represent the LSBs of the number
-    size_t add_blocks = shifts / 32;
+    size_t add_blocks = shifts / aint::block_bits;
+
+    shifts %= aint::block_bits;
 
-    shifts %= 32;
+    // one additional block for the bits pushed out of the most significant block
+    size_t length = num.number_blocks + add_blocks + 1;
 
     // reserve memory for the result and additional space
     // since numbers can use up space for additional blocks very quickly when shifting
     // reservation of memory is limited to 50 additional blocks as a buffer
-    result.reserve(static_cast<size_t>((num.number_blocks + add_blocks) * 1.5l) +1
-                   < (num.number_blocks + add_blocks + 50)
-                   ? static_cast<size_t>((num.number_blocks + add_blocks) * 1.5l) +1
-                   : (num.number_blocks + add_blocks + 50));
+    result.reserve(aint::grow(length) < (length + 50)
+                   ? aint::grow(length)
+                   : (length + 50));
+
+    for(size_t i1 = 0; i1 < add_blocks; ++i1)
+        result.storage[i1] = 0;
 
-    size_t counter_shifts = (32 - shifts);
+    if(shifts)
+        result.storage[length - 1] = kernel::lshift_n(result.storage + add_blocks, num.storage, num.number_blocks, shifts);
 
-    for (size_t i1 = num.number_blocks; i1 > 0; --i1)
+    else
     {
-        if(shifts)
-            result.storage[i1 + add_blocks] |= (num.storage[i1 - 1] >> counter_shifts);
+        for(size_t i1 = 0; i1 < num.number_blocks; ++i1)
+            result.storage[i1 + add_blocks] = num.storage[i1];
 
-        result.storage[i1 + add_blocks - 1] = (num.storage[i1 - 1] << shifts);
+        result.storage[length - 1] = 0;
     }
 
     // set the correct values for result
+    result.number_blocks = length;
 
-    result.number_blocks = add_blocks + num.number_blocks;
-
-    if(result.storage[result.number_blocks])
-    {
-        ++result.number_blocks;
-
-        result.bits_used = num.bits_used + shifts - 32;
-    }
-
-    else
-        result.bits_used = num.bits_used + shifts;
+    result.normalize();
 
     return result;
 }
@@ -944,9 +2028,9 @@ aint operator>>(const aint& num, size_t shifts)
         return num;
 
     // number of blocks that will be cut off entirely by the shift
-    size_t cut_blocks = shifts / 32;
+    size_t cut_blocks = shifts / aint::block_bits;
 
-    shifts %= 32;
+    shifts %= aint::block_bits;
 
     aint result{};
 
@@ -954,30 +2038,24 @@ aint operator>>(const aint& num, size_t shifts)
     if(cut_blocks >= num.number_blocks || ((cut_blocks +1 == num.number_blocks) && (num.bits_used <= shifts)))
         return result;
 
+    size_t length = num.number_blocks - cut_blocks;
+
     // reserve memory for the result and additional space
-    result.reserve(static_cast<size_t>((num.number_blocks - cut_blocks) *1.5l) +1);
+    result.reserve(aint::grow(length));
 
-    size_t counter_shifts = (32 - shifts);
+    if(shifts)
+        kernel::rshift_n(result.storage, num.storage + cut_blocks, length, shifts);
 
-    for(size_t i1 = 0; i1 < (num.number_blocks - cut_blocks); ++i1)
+    else
     {
-        result.storage[i1] = (num.storage[i1 + cut_blocks] >> shifts);
-
-        if(i1 && shifts)
-            result.storage[i1 -1] |= (num.storage[i1 + cut_blocks] << counter_shifts);
+        for(size_t i1 = 0; i1 < length; ++i1)
+            result.storage[i1] = num.storage[i1 + cut_blocks];
     }
 
-    result.number_blocks = num.number_blocks - cut_blocks;
-
-    if(!result.storage[result.number_blocks - 1])
-    {
-        --result.number_blocks;
-
-        result.bits_used = num.bits_used + 32 - shifts;
-    }
+    // set the correct values for result
+    result.number_blocks = length;
 
-    else
-        result.bits_used = num.bits_used - shifts;
+    result.normalize();
 
     return result;
 }
@@ -8,13 +8,20 @@
 
 #include <stdint-gcc.h>
 #include <glob.h>
+#include <charconv>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "aint_alloc.hpp"
+#include "aint_kernels.hpp"
 
 class aint final
 {
 public:
 
-    explicit aint(const uint32_t = 0);
+    explicit aint(const uint64_t = 0);
 
     aint(const aint&);
 
@@ -22,7 +29,10 @@ public:
 
     ~aint();
 
-    aint& operator=(uint32_t);
+    // read-only number on blocks owned by someone else (see below)
+    class view;
+
+    aint& operator=(uint64_t);
 
     aint& operator=(const aint&);
 
@@ -30,6 +40,9 @@ public:
 
     bool zero() const;
 
+    // number of binary digits, 0 for zero
+    size_t bit_length() const;
+
     void swap(aint&);
 
     // accumulative operators
@@ -47,6 +60,17 @@ public:
 
     aint& operator>>=(size_t);
 
+    // accumulative operators with a single word, they work on the storage of the object without temporaries
+    aint& operator+=(uint64_t);
+
+    aint& operator-=(uint64_t);
+
+    aint& operator*=(uint64_t);
+
+    aint& operator/=(uint64_t);
+
+    aint& operator%=(uint64_t);
+
     // non-member functions
 
     // I/O operators
@@ -54,6 +78,10 @@ public:
 
     friend std::istream& operator>>(std::istream&, aint&);
 
+    // writes the binary format of operator<< (least significant bit first) to [first, last), fails with
+    // std::errc::value_too_large and leaves the range untouched if it does not fit
+    friend std::to_chars_result to_chars(char* first, char* last, const aint&);
+
     // comparison operators
     friend bool operator==(const aint&, const aint&);
 
@@ -67,6 +95,31 @@ public:
 
     friend bool operator>=(const aint&, const aint&);
 
+    // comparison with a single word
+    friend bool operator==(const aint&, uint64_t);
+
+    friend bool operator==(uint64_t, const aint&);
+
+    friend bool operator!=(const aint&, uint64_t);
+
+    friend bool operator!=(uint64_t, const aint&);
+
+    friend bool operator<(const aint&, uint64_t);
+
+    friend bool operator<(uint64_t, const aint&);
+
+    friend bool operator<=(const aint&, uint64_t);
+
+    friend bool operator<=(uint64_t, const aint&);
+
+    friend bool operator>(const aint&, uint64_t);
+
+    friend bool operator>(uint64_t, const aint&);
+
+    friend bool operator>=(const aint&, uint64_t);
+
+    friend bool operator>=(uint64_t, const aint&);
+
     // binary arithmetic operators
     friend aint operator+(const aint&, const aint&);
 
@@ -74,35 +127,225 @@ public:
 
     friend aint operator*(const aint&, const aint&);
 
+    // a * a, about half the work of a general product; a * a and a *= a take this path on their own
+    friend aint square(const aint&);
+
     friend aint operator/(const aint&, const aint&);
 
     friend aint operator%(const aint&, const aint&);
 
+    // arithmetic with a single word
+    friend aint operator+(const aint&, uint64_t);
+
+    friend aint operator+(uint64_t, const aint&);
+
+    friend aint operator-(const aint&, uint64_t);
+
+    friend aint operator*(const aint&, uint64_t);
+
+    friend aint operator*(uint64_t, const aint&);
+
+    friend aint operator/(const aint&, uint64_t);
+
+    friend aint operator%(const aint&, uint64_t);
+
+    // fused arithmetic writing into an existing number whose storage is reused, r may be one of the operands
+    // the product a * b is formed in scratch storage, a single word factor is accumulated block by block
+    friend void mul(aint& r, const aint& a, const aint& b);
+
+    // r += a * b
+    friend void addmul(aint& r, const aint& a, const aint& b);
+
+    friend void addmul(aint& r, const aint& a, uint64_t b);
+
+    // r -= a * b or 0 if r <= a * b like operator-
+    friend void submul(aint& r, const aint& a, const aint& b);
+
+    friend void submul(aint& r, const aint& a, uint64_t b);
+
+    // r += a << shifts and r -= a << shifts without a shifted copy of a
+    friend void add_shifted(aint& r, const aint& a, size_t shifts);
+
+    friend void sub_shifted(aint& r, const aint& a, size_t shifts);
+
+    // quotient and remainder of one division, b = 0 gives 0 and a like operator/ and operator%
+    friend std::pair<aint, aint> divmod(const aint&, const aint&);
+
+    // the same writing into quotient and remainder which have to be different objects, their storage is reused
+    friend void divmod(const aint&, const aint&, aint&, aint&);
+
+    // division by a single word in one pass with the remainder as plain integer, b = 0 gives 0 for both
+    friend std::pair<aint, uint64_t> divmod(const aint&, uint64_t);
+
+    friend uint64_t divmod(const aint&, uint64_t, aint&);
+
+    // the same for a divisor used for many divisions, its precomputed reciprocal avoids the division instruction
+    friend uint64_t divmod(const aint&, const kernel::limb_divisor&, aint&);
+
+    // greatest common divisor, gcd(a, 0) = a
+    friend aint gcd(const aint&, const aint&);
+
+    // extended gcd, returns g = gcd(a, b) with the Bezout coefficients g = a s - b t where 0 < s <= b / g and t >= 0
+    // gcd(a, 0) = a with s = 1 and t = 0, the coefficients of gcd(0, b) would be negative and are set to 0
+    friend aint xgcd(const aint& a, const aint& b, aint& s, aint& t);
+
+    // inverse of a modulo m in [0, m), 0 if gcd(a, m) != 1 or m = 0
+    friend aint modinv(const aint& a, const aint& m);
+
+    // inverses of all numbers modulo m with a single extended gcd (Montgomery's trick)
+    friend std::vector<aint> modinv(const std::vector<aint>&, const aint& m);
+
+    // gcd of every number with the product of all other numbers by product and remainder trees, using all cores
+    // the numbers have to be non-zero
+    friend std::vector<aint> batch_gcd(const std::vector<aint>&);
+
+    // decimal and hexadecimal text (see aint_radix.cpp)
+    friend class radix_conversion;
+
+    // works on the blocks of whole numbers for the subquadratic gcd (see aint_hgcd.cpp)
+    friend class half_gcd;
+
     friend aint operator<<(const aint&, size_t);
 
     friend aint operator>>(const aint&, size_t);
 
 private:
 
+    // a block is one machine word, products and carries of two blocks are held in a double block
+    using block_type = uint64_t;
+
+    using double_block_type = unsigned __int128;
+
+    static constexpr size_t block_bits = 64;
+
+    // number of blocks held inside the object itself before switching to heap storage
+    static constexpr size_t inline_blocks = 4;
+
     // reserved storage
-    size_t capacity = 0;
+    size_t capacity = inline_blocks;
 
-    // actual size of the array i.e. number of used uint32_ts
+    // actual size of the array i.e. number of used blocks
     size_t number_blocks = 0;
 
-    // array containing the number
+    // inline buffer used for small numbers so they never touch the heap
+    block_type local_storage[inline_blocks] = {};
+
+    // array containing the number, either local_storage or a heap allocated array
     // the least significant block is at position [0] but the bits within a specific block are ordered from MSB to LSB
-    uint32_t* storage = nullptr;
+    block_type* storage = local_storage;
+
+    // allocator the heap storage has to be returned to, nullptr stands for the pool of the releasing thread
+    block_allocator* allocator = nullptr;
 
     // keep track of how many bits in the last i.e. most significant block are actually used
     size_t bits_used = 0;
 
     // internal functions for memory management
-    void push_back(uint32_t, size_t = 0, bool = false);
+    void push_back(block_type, size_t = 0, bool = false);
 
     void reserve(size_t);
 
     void shrink();
+
+    void release();
+
+    static size_t grow(size_t);
+
+    void normalize();
+
+    // adds or subtracts the normalized blocks b shifted up by offset blocks, b must not lie in the own storage
+    // the subtraction gives 0 if the object is not larger
+    void add_blocks(const block_type* b, size_t bn, size_t offset);
+
+    void sub_blocks(const block_type* b, size_t bn, size_t offset);
+
+    // -1, 0 or 1 if the number is smaller, equal or larger than the word
+    static int compare(const aint&, uint64_t);
+
+    void divide(const aint&, aint*);
+
+    void divide_blocks(const aint&, block_type*);
+
+    // makes room for the quotient of a division of the number by a single block, the number may be the object itself
+    void prepare_quotient(const aint&);
 };
 
+
+// read-only number on blocks which belong to another aint, a mapped file or any other array, nothing is copied
+// a view converts to const aint& and is therefore accepted by every operation that does not modify its operands
+// it must not outlive the blocks and must not refer to the result of an operation it is passed to
+class aint::view
+{
+public:
+
+    view(const aint&);
+
+    // the number of the blocks [blocks, blocks + count), least significant block first
+    view(const uint64_t* blocks, size_t count);
+
+    view(const view&);
+
+    view& operator=(const view&);
+
+    operator const aint&() const
+    {
+        return number;
+    }
+
+    const uint64_t* data() const
+    {
+        return number.storage;
+    }
+
+    // number of blocks without leading zero blocks
+    size_t size() const
+    {
+        return number.number_blocks;
+    }
+
+    size_t bit_length() const
+    {
+        return number.bit_length();
+    }
+
+    bool zero() const
+    {
+        return number.zero();
+    }
+
+    // the lowest k blocks, i.e. the number modulo 2^(64 k)
+    view low(size_t k) const;
+
+    // the blocks from k upwards, i.e. the number shifted right by k blocks
+    view high(size_t k) const;
+
+    // the highest k blocks
+    view top(size_t k) const;
+
+private:
+
+    void borrow(const uint64_t*, size_t);
+
+    // shares the blocks with an allocator that never releases them
+    aint number;
+};
+
+using aint_view = aint::view;
+
+
+// manipulators for the text format of operator<< and operator>>, aint_bin is the default binary format with the least
+// significant bit first, aint_dec and aint_hex write the most significant digit first like for the built-in types
+std::ios_base& aint_bin(std::ios_base&);
+
+std::ios_base& aint_dec(std::ios_base&);
+
+std::ios_base& aint_hex(std::ios_base&);
+
+// text in base 10 or 16 with the most significant digit first, any other base gives the binary format of operator<<
+std::string to_string(const aint&, unsigned base = 10);
+
+// the number given by the leading digits of the text in base 10, 16 or otherwise the binary format, 0 if there are
+// no digits
+aint from_string(std::string_view, unsigned base = 10);
+
 #endif //AINT_AINT_H
@@ -0,0 +1,223 @@
+#include <new>
+#include "aint_alloc.hpp"
+
+// allocator installed by the innermost allocator_scope of this thread
+static thread_local block_allocator* installed_allocator = nullptr;
+
+// set once the pool of this thread has been destroyed at thread exit
+// aints with static storage duration may still release their storage afterwards
+static thread_local bool pool_destroyed = false;
+
+static thread_local block_pool thread_pool;
+
+// growth policy for the rare case that a thread allocates after its pool is gone
+static growth_policy fallback_growth{};
+
+
+// smallest k with 2^k >= blocks
+static size_t ceil_log2(size_t blocks)
+{
+    return blocks <= 1 ? 0 : 64 - static_cast<size_t>(__builtin_clzll(blocks - 1));
+}
+
+
+size_t growth_policy::operator()(size_t blocks) const
+{
+    // intended cropping when converting to size_t
+    size_t grown = static_cast<size_t>(blocks * factor) + headroom;
+
+    // the operators rely on at least one spare block, whatever the policy says
+    return grown > blocks ? grown : blocks + 1;
+}
+
+
+block_allocator* block_allocator::installed()
+{
+    return installed_allocator;
+}
+
+
+uint64_t* block_allocator::acquire(size_t& blocks, block_allocator*& owner)
+{
+    // the thread pool is not recorded as owner since the storage may be freed by another thread
+    owner = installed_allocator;
+
+    if(owner)
+        return owner->allocate(blocks);
+
+    if(block_pool* pool = block_pool::local())
+        return pool->allocate(blocks);
+
+    return static_cast<uint64_t*>(::operator new(blocks * sizeof(uint64_t)));
+}
+
+
+void block_allocator::give_back(uint64_t* ptr, size_t blocks, block_allocator* owner)
+{
+    if(owner)
+        owner->deallocate(ptr, blocks);
+
+    else if(block_pool* pool = block_pool::local())
+        pool->deallocate(ptr, blocks);
+
+    else
+        ::operator delete(ptr);
+}
+
+
+growth_policy& block_allocator::current_growth()
+{
+    if(installed_allocator)
+        return installed_allocator->growth;
+
+    if(block_pool* pool = block_pool::local())
+        return pool->growth;
+
+    return fallback_growth;
+}
+
+
+block_pool::~block_pool()
+{
+    trim();
+
+    pool_destroyed = true;
+}
+
+
+uint64_t* block_pool::allocate(size_t& blocks)
+{
+    size_t size_class = ceil_log2(blocks);
+
+    if(size_class < min_class)
+        size_class = min_class;
+
+    // very large arrays are not worth caching
+    if(size_class > max_class)
+        return static_cast<uint64_t*>(::operator new(blocks * sizeof(uint64_t)));
+
+    blocks = size_t{1} << size_class;
+
+    uint64_t* ptr = free_lists[size_class];
+
+    if(ptr)
+    {
+        free_lists[size_class] = reinterpret_cast<uint64_t*>(ptr[0]);
+
+        --cached[size_class];
+
+        return ptr;
+    }
+
+    return static_cast<uint64_t*>(::operator new(blocks * sizeof(uint64_t)));
+}
+
+
+void block_pool::deallocate(uint64_t* ptr, size_t blocks)
+{
+    size_t size_class = ceil_log2(blocks);
+
+    // only arrays of exactly one size class are cached and each class keeps a bounded amount of memory
+    if(size_class < min_class || size_class > max_class || (size_t{1} << size_class) != blocks
+       || ((cached[size_class] + 1) << size_class) * sizeof(uint64_t) > max_cached_bytes)
+    {
+        ::operator delete(ptr);
+
+        return;
+    }
+
+    ptr[0] = reinterpret_cast<uint64_t>(free_lists[size_class]);
+
+    free_lists[size_class] = ptr;
+
+    ++cached[size_class];
+}
+
+
+void block_pool::trim()
+{
+    for(size_t i1 = 0; i1 <= max_class; ++i1)
+    {
+        while(free_lists[i1])
+        {
+            uint64_t* ptr = free_lists[i1];
+
+            free_lists[i1] = reinterpret_cast<uint64_t*>(ptr[0]);
+
+            ::operator delete(ptr);
+        }
+
+        cached[i1] = 0;
+    }
+}
+
+
+void block_pool::trim_local()
+{
+    if(block_pool* pool = local())
+        pool->trim();
+}
+
+
+block_pool* block_pool::local()
+{
+    return pool_destroyed ? nullptr : &thread_pool;
+}
+
+
+block_arena::block_arena(size_t initial_blocks) : chunk_blocks(initial_blocks ? initial_blocks : 1)
+{
+    // numbers in an arena are short lived so there is no need for much headroom
+    growth.factor = 1.0l;
+}
+
+
+block_arena::~block_arena()
+{
+    for(auto chunk : chunks)
+        ::operator delete(chunk);
+}
+
+
+uint64_t* block_arena::allocate(size_t& blocks)
+{
+    if(static_cast<size_t>(end - top) < blocks)
+    {
+        size_t size = blocks > chunk_blocks ? blocks : chunk_blocks;
+
+        top = static_cast<uint64_t*>(::operator new(size * sizeof(uint64_t)));
+
+        end = top + size;
+
+        chunks.push_back(top);
+
+        // every new chunk is twice as large as the previous one to keep the number of chunks logarithmic
+        chunk_blocks *= 2;
+    }
+
+    uint64_t* ptr = top;
+
+    top += blocks;
+
+    return ptr;
+}
+
+
+void block_arena::deallocate(uint64_t* ptr, size_t blocks)
+{
+    // the most recent allocation can be rolled back which keeps temporaries from piling up
+    if(ptr + blocks == top)
+        top = ptr;
+}
+
+
+allocator_scope::allocator_scope(block_allocator& allocator) : previous(installed_allocator)
+{
+    installed_allocator = &allocator;
+}
+
+
+allocator_scope::~allocator_scope()
+{
+    installed_allocator = previous;
+}
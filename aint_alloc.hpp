@@ -0,0 +1,153 @@
+#ifndef AINT_AINT_ALLOC_H
+#define AINT_AINT_ALLOC_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// decides how many blocks a number reserves when it has to grow to a given size
+// the result is always at least one block more than the size itself
+struct growth_policy
+{
+    long double factor = 1.5l;
+
+    size_t headroom = 1;
+
+    size_t operator()(size_t blocks) const;
+};
+
+
+// source of the heap storage used by aint
+// small numbers live in the inline buffer of aint and never reach an allocator
+class block_allocator
+{
+public:
+
+    virtual ~block_allocator() = default;
+
+    // returns storage for at least the requested number of blocks and updates the request to the actual capacity
+    virtual uint64_t* allocate(size_t&) = 0;
+
+    virtual void deallocate(uint64_t*, size_t) = 0;
+
+    growth_policy growth;
+
+    // allocator installed for the calling thread by an allocator_scope or nullptr if the thread pool is used
+    static block_allocator* installed();
+
+    // allocates from the installed allocator or the thread pool and reports which one has to take the storage back
+    static uint64_t* acquire(size_t&, block_allocator*&);
+
+    static void give_back(uint64_t*, size_t, block_allocator*);
+
+    // growth policy of the allocator used by the calling thread
+    static growth_policy& current_growth();
+};
+
+
+// default allocator with one instance per thread
+// freed arrays are kept in power of two size classes and handed out again on the next request of that class
+// storage may be freed on a different thread than it was allocated on, it then simply joins that thread's pool
+class block_pool final : public block_allocator
+{
+public:
+
+    block_pool() = default;
+
+    block_pool(const block_pool&) = delete;
+
+    block_pool& operator=(const block_pool&) = delete;
+
+    ~block_pool() override;
+
+    uint64_t* allocate(size_t&) override;
+
+    void deallocate(uint64_t*, size_t) override;
+
+    // frees all cached arrays
+    void trim();
+
+    // frees the cached arrays of the calling thread, e.g. after a large computation
+    static void trim_local();
+
+    // pool of the calling thread or nullptr if it was already destroyed at thread exit
+    static block_pool* local();
+
+private:
+
+    // size class k holds arrays of 2^k blocks, larger requests bypass the pool
+    static constexpr size_t min_class = 3;
+
+    static constexpr size_t max_class = 19;
+
+    // upper limit for the memory a single size class keeps cached, at least one array of the largest class fits
+    static constexpr size_t max_cached_bytes = size_t{1} << 22;
+
+    static_assert((size_t{1} << max_class) * sizeof(uint64_t) <= max_cached_bytes, "the largest class is never cached");
+
+    // singly linked lists threaded through the first block of each cached array
+    uint64_t* free_lists[max_class + 1] = {};
+
+    size_t cached[max_class + 1] = {};
+};
+
+
+// bump allocator for batch computations, all of its storage is released at once when it is destroyed
+// every aint using storage of an arena has to be destroyed before the arena and must stay on the installing thread
+//
+// usage:
+//     block_arena arena;
+//     {
+//         allocator_scope scope{arena};
+//         // aints created or grown here take their storage from the arena
+//     }
+class block_arena final : public block_allocator
+{
+public:
+
+    explicit block_arena(size_t = 1 << 16);
+
+    block_arena(const block_arena&) = delete;
+
+    block_arena& operator=(const block_arena&) = delete;
+
+    ~block_arena() override;
+
+    uint64_t* allocate(size_t&) override;
+
+    // only the most recent allocation is actually returned, everything else waits for the arena to be destroyed
+    void deallocate(uint64_t*, size_t) override;
+
+private:
+
+    // size in blocks of the next chunk that will be requested from the system
+    size_t chunk_blocks;
+
+    std::vector<uint64_t*> chunks;
+
+    uint64_t* top = nullptr;
+
+    uint64_t* end = nullptr;
+};
+
+
+// installs an allocator for the calling thread until the scope ends
+class allocator_scope
+{
+public:
+
+    explicit allocator_scope(block_allocator&);
+
+    allocator_scope(const allocator_scope&) = delete;
+
+    allocator_scope& operator=(const allocator_scope&) = delete;
+
+    ~allocator_scope();
+
+private:
+
+    block_allocator* previous;
+};
+
+#endif //AINT_AINT_ALLOC_H
@@ -0,0 +1,125 @@
+/* Batch gcd
+ *
+ * batch_gcd() computes the gcd of every number with the product of all other numbers in quasi-linear time with the
+ * product and remainder trees of Bernstein (How to find smooth parts of integers, 2004) instead of comparing all
+ * pairs:
+ *
+ * The product tree multiplies neighbouring numbers level by level until the root holds the product P of all numbers.
+ * The remainder tree goes back down and reduces the remainder of the parent node modulo the square of every node,
+ * so the leaves receive P mod x^2 for every number x. Since P / x is the product of all other numbers,
+ * (P mod x^2) / x = (P / x) mod x and its gcd with x is the result.
+ *
+ * All nodes of one level are independent. Each level is processed by up to one thread per core, every thread taking
+ * the next node until none is left. The upper levels consist of a few large products, the lower ones of many small
+ * ones, so this keeps the cores busy except for the root. Memory is taken from the pool of the working thread and
+ * may be given back by another thread.
+ */
+#include <atomic>
+#include <thread>
+#include "aint.hpp"
+
+
+// calls work(i1) for all i1 < count on as many threads as there are cores
+template<typename F>
+static void parallel_for(size_t count, F work)
+{
+    size_t threads = std::thread::hardware_concurrency();
+
+    if(threads > count)
+        threads = count;
+
+    if(threads <= 1)
+    {
+        for(size_t i1 = 0; i1 < count; ++i1)
+            work(i1);
+
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]()
+    {
+        for(size_t i1 = next++; i1 < count; i1 = next++)
+            work(i1);
+    };
+
+    // the calling thread works as well
+    std::vector<std::thread> pool;
+
+    for(size_t i1 = 1; i1 < threads; ++i1)
+        pool.emplace_back(worker);
+
+    worker();
+
+    for(auto& thread : pool)
+        thread.join();
+}
+
+
+std::vector<aint> batch_gcd(const std::vector<aint>& numbers)
+{
+    std::vector<aint> result(numbers.size());
+
+    // the product of no other numbers is 1
+    if(numbers.size() < 2)
+    {
+        for(auto& value : result)
+            value = 1;
+
+        return result;
+    }
+
+    // the levels above the numbers, each holds the products of pairs of the level below
+    // a node without partner is taken over unchanged
+    std::vector<std::vector<aint>> tree{};
+
+    auto level = [&](size_t height) -> const std::vector<aint>&
+    {
+        return height ? tree[height - 1] : numbers;
+    };
+
+    while(level(tree.size()).size() > 1)
+    {
+        const std::vector<aint>& below = level(tree.size());
+
+        std::vector<aint> products((below.size() + 1) / 2);
+
+        parallel_for(products.size(), [&](size_t i1)
+        {
+            products[i1] = 2 * i1 + 1 < below.size() ? below[2 * i1] * below[2 * i1 + 1] : below[2 * i1];
+        });
+
+        tree.push_back(std::move(products));
+    }
+
+    // remainders of the product of all numbers modulo the squares of the nodes, from the root down
+    std::vector<aint> remainders = std::move(tree.back());
+
+    tree.pop_back();
+
+    for(size_t height = tree.size() + 1; height > 0; --height)
+    {
+        const std::vector<aint>& nodes = level(height - 1);
+
+        std::vector<aint> next(nodes.size());
+
+        parallel_for(nodes.size(), [&](size_t i1)
+        {
+            next[i1] = remainders[i1 / 2] % square(nodes[i1]);
+        });
+
+        remainders.swap(next);
+
+        // the products are not needed anymore once the level below has its remainders
+        if(height > 1)
+            tree.pop_back();
+    }
+
+    parallel_for(numbers.size(), [&](size_t i1)
+    {
+        result[i1] = gcd(numbers[i1], remainders[i1] / numbers[i1]);
+    });
+
+    return result;
+}
@@ -0,0 +1,337 @@
+/* Division
+ *
+ * kernel::div_qr_basecase is the schoolbook division of Knuth (The Art of Computer Programming, Vol. 2, 4.3.1,
+ * Algorithm D): the quotient is produced one limb at a time from the most significant end. Each quotient limb is
+ * estimated by dividing the top two limbs of the partial remainder by the top limb of the divisor and corrected with
+ * the second limb of the divisor, after which the estimate is at most one too large. The rare remaining error is
+ * detected by the borrow of the multiply and subtract step and fixed by adding the divisor back once.
+ *
+ * The estimate is only that good if the most significant bit of the divisor is set, so the caller shifts both
+ * operands by the same amount beforehand and shifts the remainder back afterwards.
+ *
+ * Above kernel::thresholds.div_dc kernel::div_qr switches to the recursive division of Burnikel and Ziegler in the
+ * form used by GMP (mpn_dcpi1_div_qr): a 2n by n division is split into two 3/2 n by n divisions, each of which
+ * computes half of the quotient by a recursive n by n/2 division of the upper limbs and corrects the remainder
+ * with one product of the estimated quotient half and the lower half of the divisor. The products use the fast
+ * multiplication, so a division costs a small multiple of a multiplication of the same size.
+ * Longer dividends are processed in pieces of the length of the divisor from the most significant end.
+ *
+ * Single limb divisors take one pass over the dividend, either with the 128 by 64 bit division of the processor or,
+ * if the divisor is reused, with a precomputed reciprocal (kernel::limb_divisor) that replaces every division by
+ * two multiplications.
+ */
+#include "aint_kernels.hpp"
+
+using kernel::limb;
+using kernel::double_limb;
+
+
+// divides u1 B + u0 by the normalized d with u1 < d using its reciprocal (Moller and Granlund, algorithm 4)
+static inline limb div_2by1_preinv(limb& r, limb u1, limb u0, limb d, limb reciprocal)
+{
+    double_limb estimate = static_cast<double_limb>(reciprocal) * u1
+                           + ((static_cast<double_limb>(u1 + 1) << kernel::limb_bits) | u0);
+
+    limb q = static_cast<limb>(estimate >> kernel::limb_bits);
+
+    // intended cropping, the remainder is computed modulo B
+    r = u0 - q * d;
+
+    // the estimate is at most one too large or one too small
+    if(r > static_cast<limb>(estimate))
+    {
+        --q;
+
+        r += d;
+    }
+
+    if(r >= d)
+    {
+        ++q;
+
+        r -= d;
+    }
+
+    return q;
+}
+
+
+limb kernel::divrem_1(limb* q, const limb* a, size_t n, limb d)
+{
+    limb remainder = 0;
+
+    // the partial remainder is always smaller than d so every quotient limb fits into a limb
+    for(size_t i1 = n; i1 > 0; --i1)
+    {
+#if defined(__x86_64__)
+        // the hardware divides 128 by 64 bits directly as long as the quotient fits into 64 bits
+        limb quotient;
+
+        __asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(a[i1 - 1]), "d"(remainder), "rm"(d));
+
+        q[i1 - 1] = quotient;
+#else
+        double_limb dividend = (static_cast<double_limb>(remainder) << limb_bits) | a[i1 - 1];
+
+        q[i1 - 1] = static_cast<limb>(dividend / d);
+
+        remainder = static_cast<limb>(dividend % d);
+#endif
+    }
+
+    return remainder;
+}
+
+
+limb kernel::mod_1(const limb* a, size_t n, limb d)
+{
+    limb remainder = 0;
+
+    for(size_t i1 = n; i1 > 0; --i1)
+    {
+#if defined(__x86_64__)
+        limb quotient;
+
+        __asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(a[i1 - 1]), "d"(remainder), "rm"(d));
+#else
+        remainder = static_cast<limb>(((static_cast<double_limb>(remainder) << limb_bits) | a[i1 - 1]) % d);
+#endif
+    }
+
+    return remainder;
+}
+
+
+kernel::limb_divisor::limb_divisor(limb d) : value(d)
+{
+    if(!d)
+        return;
+
+    shift = limb_bits - significant_bits(d);
+
+    normalized = d << shift;
+
+    // floor((B^2 - 1) / normalized) - B
+    reciprocal = static_cast<limb>(((static_cast<double_limb>(~normalized) << limb_bits) | ~limb{0}) / normalized);
+}
+
+
+limb kernel::divrem_1_preinv(limb* q, const limb* a, size_t n, const limb_divisor& d)
+{
+    if(!n)
+        return 0;
+
+    // a is shifted on the fly like the divisor, which does not change the quotient
+    limb remainder = d.shift ? a[n - 1] >> (limb_bits - d.shift) : 0;
+
+    for(size_t i1 = n; i1 > 0; --i1)
+    {
+        limb next = d.shift ? (a[i1 - 1] << d.shift) | (i1 > 1 ? a[i1 - 2] >> (limb_bits - d.shift) : 0) : a[i1 - 1];
+
+        q[i1 - 1] = div_2by1_preinv(remainder, remainder, next, d.normalized, d.reciprocal);
+    }
+
+    return remainder >> d.shift;
+}
+
+
+limb kernel::div_qr_basecase(limb* q, limb* n, size_t nn, const limb* d, size_t dn)
+{
+    limb d1 = d[dn - 1];
+
+    limb d0 = d[dn - 2];
+
+    // the top dn limbs of n may exceed d once, afterwards the partial remainder always stays below d
+    limb high = cmp_n(n + nn - dn, d, dn) >= 0;
+
+    if(high)
+        sub_n(n + nn - dn, n + nn - dn, d, dn);
+
+    for(size_t i1 = nn - dn; i1 > 0; --i1)
+    {
+        // the partial remainder part[0..dn] is divided by d, part[dn] <= d1 holds since it is smaller than d * B
+        limb* part = n + i1 - 1;
+
+        limb n2 = part[dn];
+
+        limb n1 = part[dn - 1];
+
+        limb n0 = part[dn - 2];
+
+        limb qhat;
+
+        limb rhat;
+
+        bool rhat_overflow = false;
+
+        if(n2 >= d1)
+        {
+            // (n2 B + n1) / d1 would not fit into a limb, B - 1 is an upper bound for the quotient limb
+            qhat = ~limb{0};
+
+            rhat = n1 + d1;
+
+            rhat_overflow = rhat < n1;
+        }
+
+        else
+        {
+            double_limb dividend = (static_cast<double_limb>(n2) << limb_bits) | n1;
+
+            qhat = static_cast<limb>(dividend / d1);
+
+            rhat = static_cast<limb>(dividend - static_cast<double_limb>(qhat) * d1);
+        }
+
+        // at most two corrections with the second limb of the divisor
+        while(!rhat_overflow
+              && static_cast<double_limb>(qhat) * d0 > ((static_cast<double_limb>(rhat) << limb_bits) | n0))
+        {
+            --qhat;
+
+            rhat += d1;
+
+            rhat_overflow = rhat < d1;
+        }
+
+        limb borrow = submul_1(part, d, dn, qhat);
+
+        // the estimate was still one too large
+        if(n2 < borrow)
+        {
+            --qhat;
+
+            add_n(part, part, d, dn);
+        }
+
+        part[dn] = 0;
+
+        q[i1 - 1] = qhat;
+    }
+
+    return high;
+}
+
+
+// the recursion needs at least two limbs in each half of the divisor
+static bool below_div_dc(size_t size)
+{
+    return size < 4 || size < kernel::thresholds.div_dc;
+}
+
+
+// divides the 2n limbs of np by the normalized n limbs of d, q receives n limbs of the quotient and the remainder
+// replaces the low n limbs of np, returns the most significant limb of the quotient which is 0 or 1
+// t is a temporary of n limbs
+static limb div_qr_n(limb* q, limb* np, const limb* d, size_t n, limb* t)
+{
+    size_t low = n / 2;
+
+    size_t high = n - low;
+
+    // upper half of the quotient from the upper 2 high limbs of np and the upper half of d
+    limb quotient_high = below_div_dc(high) ? kernel::div_qr_basecase(q + low, np + 2 * low, 2 * high, d + low, high)
+                                            : div_qr_n(q + low, np + 2 * low, d + low, high, t);
+
+    // the partial remainder still lacks the product of this quotient half with the lower half of d
+    kernel::mul(t, q + low, high, d, low);
+
+    limb borrow = kernel::sub_n(np + low, np + low, t, n);
+
+    if(quotient_high)
+        borrow += kernel::sub_n(np + n, np + n, d, low);
+
+    // the quotient half was too large, every step adds d back
+    while(borrow)
+    {
+        quotient_high -= kernel::sub_1(q + low, q + low, high, 1);
+
+        borrow -= kernel::add_n(np + low, np + low, d, n);
+    }
+
+    // lower half of the quotient in the same way
+    limb quotient_low = below_div_dc(low) ? kernel::div_qr_basecase(q, np + high, 2 * low, d + high, low)
+                                          : div_qr_n(q, np + high, d + high, low, t);
+
+    kernel::mul(t, d, high, q, low);
+
+    borrow = kernel::sub_n(np, np, t, n);
+
+    if(quotient_low)
+        borrow += kernel::sub_n(np + low, np + low, d, high);
+
+    while(borrow)
+    {
+        kernel::sub_1(q, q, low, 1);
+
+        borrow -= kernel::add_n(np, np, d, n);
+    }
+
+    return quotient_high;
+}
+
+
+// divides the dn + qn limbs of np by the normalized dn limbs of d with qn < dn where the upper dn limbs of np are
+// smaller than d, so the quotient has qn limbs, t is a temporary of dn limbs
+static void div_qr_partial(limb* q, limb* np, size_t qn, const limb* d, size_t dn, limb* t)
+{
+    if(below_div_dc(qn))
+    {
+        kernel::div_qr_basecase(q, np, dn + qn, d, dn);
+
+        return;
+    }
+
+    // the quotient is estimated from the upper 2 qn limbs of np and the upper qn limbs of d
+    size_t rest = dn - qn;
+
+    limb quotient_high = div_qr_n(q, np + rest, d + rest, qn, t);
+
+    // and corrected by the product with the remaining limbs of d
+    if(qn >= rest)
+        kernel::mul(t, q, qn, d, rest);
+
+    else
+        kernel::mul(t, d, rest, q, qn);
+
+    limb borrow = kernel::sub_n(np, np, t, dn);
+
+    if(quotient_high)
+        borrow += kernel::sub_n(np + qn, np + qn, d, rest);
+
+    // the estimate is at most a few units too large and the final quotient fits into qn limbs
+    while(borrow)
+    {
+        kernel::sub_1(q, q, qn, 1);
+
+        borrow -= kernel::add_n(np, np, d, dn);
+    }
+}
+
+
+limb kernel::div_qr(limb* q, limb* n, size_t nn, const limb* d, size_t dn)
+{
+    size_t qn = nn - dn;
+
+    if(below_div_dc(dn) || below_div_dc(qn))
+        return div_qr_basecase(q, n, nn, d, dn);
+
+    limb high = cmp_n(n + qn, d, dn) >= 0;
+
+    if(high)
+        sub_n(n + qn, n + qn, d, dn);
+
+    kernel::scratch temp{dn};
+
+    // the most significant piece takes the part of the quotient that is not a multiple of dn long
+    size_t piece = qn % dn;
+
+    if(piece)
+        div_qr_partial(q + qn - piece, n + qn - piece, piece, d, dn, temp.get());
+
+    // every further piece divides 2 dn limbs whose upper half is already smaller than d
+    for(size_t offset = qn - piece; offset > 0; offset -= dn)
+        div_qr_n(q + offset - dn, n + offset - dn, d, dn, temp.get());
+
+    return high;
+}
@@ -0,0 +1,510 @@
+#ifndef AINT_AINT_EXPR_H
+#define AINT_AINT_EXPR_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "aint.hpp"
+
+// lazy arithmetic on aint, an opt-in alternative to the operators which return a new number for every step
+//
+// usage:
+//     using aint_expr::lazy;
+//
+//     evaluate(r, lazy(a) * b + c - d);       // r = a * b + c - d in the storage of r
+//     evaluate(r, lazy(r) * x + c);           // one step of Horner's method without a temporary
+//     aint s = evaluate(lazy(a) + (lazy(b) << 64));
+//     evaluate(r, lazy(a) * 7u + 1u);         // single words have to be unsigned
+//
+// lazy() wraps a number into a leaf, and +, -, * and << on a leaf build a tree of the whole expression instead of
+// computing anything. evaluate() runs through the tree once and writes into the destination:
+// the leftmost operand is evaluated into the destination, the other terms are added or subtracted in place, so
+// x + a * b becomes addmul(x, a, b), x - a * b becomes submul(x, a, b) and x + (a << k) becomes add_shifted(x, a, k).
+// Only operands of a product or a shift which are not plain numbers need a temporary aint.
+// The results are the same as with the eager operators, including the saturation of a - b at 0, the destination
+// may appear anywhere in the expression. The tree refers to its numbers, so it is meant to be evaluated in the same
+// statement in which it is built.
+namespace aint_expr
+{
+    struct node
+    {
+    };
+
+    template<class E>
+    constexpr bool is_node = std::is_base_of<node, E>::value;
+
+    // the numbers of a tree are either nodes or plain numbers which are wrapped into leaves
+    struct leaf : node
+    {
+        explicit leaf(const aint& value) : value(value)
+        {
+        }
+
+        bool refers_to(const aint& x) const
+        {
+            return &value == &x;
+        }
+
+        void evaluate_into(aint& r) const
+        {
+            if(&value != &r)
+                r = value;
+        }
+
+        void add_to(aint& r) const
+        {
+            r += value;
+        }
+
+        void subtract_from(aint& r) const
+        {
+            r -= value;
+        }
+
+        const aint& materialize(aint&) const
+        {
+            return value;
+        }
+
+        const aint& value;
+    };
+
+    struct word : node
+    {
+        explicit word(uint64_t value) : value(value)
+        {
+        }
+
+        bool refers_to(const aint&) const
+        {
+            return false;
+        }
+
+        void evaluate_into(aint& r) const
+        {
+            r = value;
+        }
+
+        void add_to(aint& r) const
+        {
+            r += value;
+        }
+
+        void subtract_from(aint& r) const
+        {
+            r -= value;
+        }
+
+        const aint& materialize(aint& temp) const
+        {
+            temp = value;
+
+            return temp;
+        }
+
+        uint64_t value;
+    };
+
+    // materialize() returns the plain number of a node, every node which is not a leaf is evaluated into temp for it
+    template<class L, class R>
+    struct sum : node
+    {
+        sum(const L& left, const R& right) : left(left), right(right)
+        {
+        }
+
+        bool refers_to(const aint& x) const
+        {
+            return left.refers_to(x) || right.refers_to(x);
+        }
+
+        // the term which does not read r is added last, the sum is commutative
+        void evaluate_into(aint& r) const
+        {
+            if(!right.refers_to(r))
+            {
+                left.evaluate_into(r);
+
+                right.add_to(r);
+            }
+
+            else if(!left.refers_to(r))
+            {
+                right.evaluate_into(r);
+
+                left.add_to(r);
+            }
+
+            else
+            {
+                aint temp{};
+
+                evaluate_into(temp);
+
+                r.swap(temp);
+            }
+        }
+
+        void add_to(aint& r) const
+        {
+            if(!right.refers_to(r))
+            {
+                left.add_to(r);
+
+                right.add_to(r);
+            }
+
+            else if(!left.refers_to(r))
+            {
+                right.add_to(r);
+
+                left.add_to(r);
+            }
+
+            else
+            {
+                aint temp{};
+
+                evaluate_into(temp);
+
+                r += temp;
+            }
+        }
+
+        // r - (a + b) = (r - a) - b also when the difference saturates at 0
+        void subtract_from(aint& r) const
+        {
+            if(!right.refers_to(r))
+            {
+                left.subtract_from(r);
+
+                right.subtract_from(r);
+            }
+
+            else if(!left.refers_to(r))
+            {
+                right.subtract_from(r);
+
+                left.subtract_from(r);
+            }
+
+            else
+            {
+                aint temp{};
+
+                evaluate_into(temp);
+
+                r -= temp;
+            }
+        }
+
+        const aint& materialize(aint& temp) const
+        {
+            evaluate_into(temp);
+
+            return temp;
+        }
+
+        L left;
+
+        R right;
+    };
+
+    template<class L, class R>
+    struct difference : node
+    {
+        difference(const L& left, const R& right) : left(left), right(right)
+        {
+        }
+
+        bool refers_to(const aint& x) const
+        {
+            return left.refers_to(x) || right.refers_to(x);
+        }
+
+        void evaluate_into(aint& r) const
+        {
+            if(!right.refers_to(r))
+            {
+                left.evaluate_into(r);
+
+                right.subtract_from(r);
+            }
+
+            else
+            {
+                aint temp{};
+
+                evaluate_into(temp);
+
+                r.swap(temp);
+            }
+        }
+
+        // the difference saturates on its own and is therefore computed first
+        void add_to(aint& r) const
+        {
+            aint temp{};
+
+            evaluate_into(temp);
+
+            r += temp;
+        }
+
+        void subtract_from(aint& r) const
+        {
+            aint temp{};
+
+            evaluate_into(temp);
+
+            r -= temp;
+        }
+
+        const aint& materialize(aint& temp) const
+        {
+            evaluate_into(temp);
+
+            return temp;
+        }
+
+        L left;
+
+        R right;
+    };
+
+    template<class L, class R>
+    struct product : node
+    {
+        product(const L& left, const R& right) : left(left), right(right)
+        {
+        }
+
+        bool refers_to(const aint& x) const
+        {
+            return left.refers_to(x) || right.refers_to(x);
+        }
+
+        // mul, addmul and submul cope with r being one of the factors
+        void evaluate_into(aint& r) const
+        {
+            aint left_temp{}, right_temp{};
+
+            mul(r, left.materialize(left_temp), right.materialize(right_temp));
+        }
+
+        void add_to(aint& r) const
+        {
+            aint left_temp{}, right_temp{};
+
+            addmul(r, left.materialize(left_temp), right.materialize(right_temp));
+        }
+
+        void subtract_from(aint& r) const
+        {
+            aint left_temp{}, right_temp{};
+
+            submul(r, left.materialize(left_temp), right.materialize(right_temp));
+        }
+
+        const aint& materialize(aint& temp) const
+        {
+            evaluate_into(temp);
+
+            return temp;
+        }
+
+        L left;
+
+        R right;
+    };
+
+    // product with a single word
+    template<class L>
+    struct scaled : node
+    {
+        scaled(const L& left, uint64_t factor) : left(left), factor(factor)
+        {
+        }
+
+        bool refers_to(const aint& x) const
+        {
+            return left.refers_to(x);
+        }
+
+        void evaluate_into(aint& r) const
+        {
+            left.evaluate_into(r);
+
+            r *= factor;
+        }
+
+        void add_to(aint& r) const
+        {
+            aint temp{};
+
+            addmul(r, left.materialize(temp), factor);
+        }
+
+        void subtract_from(aint& r) const
+        {
+            aint temp{};
+
+            submul(r, left.materialize(temp), factor);
+        }
+
+        const aint& materialize(aint& temp) const
+        {
+            evaluate_into(temp);
+
+            return temp;
+        }
+
+        L left;
+
+        uint64_t factor;
+    };
+
+    template<class L>
+    struct shifted : node
+    {
+        shifted(const L& left, size_t shifts) : left(left), shifts(shifts)
+        {
+        }
+
+        bool refers_to(const aint& x) const
+        {
+            return left.refers_to(x);
+        }
+
+        void evaluate_into(aint& r) const
+        {
+            left.evaluate_into(r);
+
+            r <<= shifts;
+        }
+
+        void add_to(aint& r) const
+        {
+            aint temp{};
+
+            add_shifted(r, left.materialize(temp), shifts);
+        }
+
+        void subtract_from(aint& r) const
+        {
+            aint temp{};
+
+            sub_shifted(r, left.materialize(temp), shifts);
+        }
+
+        const aint& materialize(aint& temp) const
+        {
+            evaluate_into(temp);
+
+            return temp;
+        }
+
+        L left;
+
+        size_t shifts;
+    };
+
+    inline leaf lazy(const aint& value)
+    {
+        return leaf{value};
+    }
+
+    // a plain number next to a node becomes a leaf, a single word becomes a word or the factor of a scaled node
+    template<class E, std::enable_if_t<is_node<E>, int> = 0>
+    const E& operand(const E& e)
+    {
+        return e;
+    }
+
+    inline leaf operand(const aint& value)
+    {
+        return leaf{value};
+    }
+
+    // only unsigned words, a negative int would silently wrap around to a huge word
+    template<class W, std::enable_if_t<std::is_integral<W>::value && std::is_unsigned<W>::value
+                                       && !std::is_same<W, bool>::value, int> = 0>
+    word operand(W value)
+    {
+        return word{static_cast<uint64_t>(value)};
+    }
+
+    template<class A>
+    using operand_type = std::decay_t<decltype(operand(std::declval<const A&>()))>;
+
+    // at least one node and the other operand has to be a node, a number or an unsigned word
+    template<class A, class B>
+    using node_operands = std::enable_if_t<(is_node<A> || is_node<B>) && is_node<operand_type<A>>
+                                           && is_node<operand_type<B>>, int>;
+
+    template<class A, class B, node_operands<A, B> = 0>
+    auto operator+(const A& a, const B& b)
+    {
+        using L = operand_type<A>;
+
+        using R = operand_type<B>;
+
+        return sum<L, R>{operand(a), operand(b)};
+    }
+
+    template<class A, class B, node_operands<A, B> = 0>
+    auto operator-(const A& a, const B& b)
+    {
+        using L = operand_type<A>;
+
+        using R = operand_type<B>;
+
+        return difference<L, R>{operand(a), operand(b)};
+    }
+
+    template<class A, class B, node_operands<A, B> = 0>
+    auto operator*(const A& a, const B& b)
+    {
+        using L = operand_type<A>;
+
+        using R = operand_type<B>;
+
+        if constexpr(std::is_same<R, word>::value)
+            return scaled<L>{operand(a), operand(b).value};
+
+        else if constexpr(std::is_same<L, word>::value)
+            return scaled<R>{operand(b), operand(a).value};
+
+        else
+            return product<L, R>{operand(a), operand(b)};
+    }
+
+    template<class E, std::enable_if_t<is_node<E>, int> = 0>
+    shifted<E> operator<<(const E& e, size_t shifts)
+    {
+        return shifted<E>{e, shifts};
+    }
+
+    // writes the value of the expression into r, the storage of r is reused
+    template<class E, std::enable_if_t<is_node<E>, int> = 0>
+    aint& evaluate(aint& r, const E& e)
+    {
+        e.evaluate_into(r);
+
+        return r;
+    }
+
+    template<class E, std::enable_if_t<is_node<E>, int> = 0>
+    aint evaluate(const E& e)
+    {
+        aint r{};
+
+        e.evaluate_into(r);
+
+        return r;
+    }
+}
+
+#endif //AINT_AINT_EXPR_H
@@ -0,0 +1,243 @@
+/* Binary container
+ *
+ * Text costs one character per bit and a full parse on every load, so many numbers are stored in a binary file with
+ * the blocks as they are in memory:
+ *
+ *     header   32 bytes: "AINTFILE", version (uint32), bits per block (uint32), count (uint64), index offset (uint64)
+ *     blocks   the blocks of all numbers one after the other, least significant block first
+ *     index    count + 1 offsets (uint64) of the numbers in blocks from the start of the blocks
+ *
+ * All values are little endian. Number i consists of the blocks between the offsets i and i + 1. The index is at the
+ * end so the writer can stream the numbers without knowing their count in advance, it fills in the header last.
+ *
+ * The reader maps the whole file into memory and checks the header and the index. Every number becomes an aint_view
+ * of its blocks inside the mapping. The blocks start at a multiple of 8 bytes
+ * in a page aligned mapping so the kernels read them directly. Loading costs nothing but the page faults of the blocks
+ * that are actually used, and repeated loads of the same file are served from the page cache.
+ */
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "aint_file.hpp"
+#include "aint_kernels.hpp"
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "the blocks of the file are mapped as they are");
+
+
+struct file_header
+{
+    char magic[8];
+
+    uint32_t version;
+
+    uint32_t block_bits;
+
+    uint64_t count;
+
+    uint64_t index_offset;
+};
+
+static_assert(sizeof(file_header) == 32, "the blocks have to start at a multiple of 8 bytes");
+
+static const char file_magic[8] = {'A', 'I', 'N', 'T', 'F', 'I', 'L', 'E'};
+
+constexpr uint32_t file_version = 1;
+
+
+aint_file_writer::aint_file_writer(const char* path) : file{path, std::ios::binary | std::ios::trunc}
+{
+    // the header is completed by close()
+    file_header header{};
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+
+aint_file_writer::~aint_file_writer()
+{
+    close();
+}
+
+
+bool aint_file_writer::good() const
+{
+    return static_cast<bool>(file);
+}
+
+
+bool aint_file_writer::write(const aint& num)
+{
+    if(closed)
+        return false;
+
+    aint_view blocks{num};
+
+    file.write(reinterpret_cast<const char*>(blocks.data()),
+               static_cast<std::streamsize>(blocks.size() * sizeof(uint64_t)));
+
+    offsets.push_back(offsets.back() + blocks.size());
+
+    return good();
+}
+
+
+bool aint_file_writer::close()
+{
+    if(closed)
+        return good();
+
+    closed = true;
+
+    file_header header{};
+
+    std::memcpy(header.magic, file_magic, sizeof(file_magic));
+
+    header.version = file_version;
+
+    header.block_bits = kernel::limb_bits;
+
+    header.count = offsets.size() - 1;
+
+    header.index_offset = sizeof(file_header) + offsets.back() * sizeof(uint64_t);
+
+    file.write(reinterpret_cast<const char*>(offsets.data()),
+               static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+
+    file.seekp(0);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    file.close();
+
+    return good();
+}
+
+
+mapped_aint_file::mapped_aint_file(const char* path)
+{
+    open(path);
+}
+
+
+mapped_aint_file::~mapped_aint_file()
+{
+    close();
+}
+
+
+bool mapped_aint_file::open(const char* path)
+{
+    close();
+
+    int descriptor = ::open(path, O_RDONLY);
+
+    if(descriptor < 0)
+        return false;
+
+    struct stat status{};
+
+    if(fstat(descriptor, &status) || static_cast<size_t>(status.st_size) < sizeof(file_header))
+    {
+        ::close(descriptor);
+
+        return false;
+    }
+
+    mapping_bytes = static_cast<size_t>(status.st_size);
+
+    mapping = mmap(nullptr, mapping_bytes, PROT_READ, MAP_SHARED, descriptor, 0);
+
+    // the mapping stays valid without the descriptor
+    ::close(descriptor);
+
+    if(mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+
+        mapping_bytes = 0;
+
+        return false;
+    }
+
+    const auto* bytes = static_cast<const char*>(mapping);
+
+    file_header header{};
+
+    std::memcpy(&header, bytes, sizeof(header));
+
+    // the index has to fill the rest of the file exactly
+    bool valid = !std::memcmp(header.magic, file_magic, sizeof(file_magic)) && header.version == file_version
+                 && header.block_bits == kernel::limb_bits && header.index_offset >= sizeof(file_header)
+                 && header.index_offset % sizeof(uint64_t) == 0 && header.index_offset <= mapping_bytes
+                 && header.count < (mapping_bytes - header.index_offset) / sizeof(uint64_t)
+                 && mapping_bytes - header.index_offset == (header.count + 1) * sizeof(uint64_t);
+
+    if(!valid)
+    {
+        close();
+
+        return false;
+    }
+
+    const auto* offsets = reinterpret_cast<const uint64_t*>(bytes + header.index_offset);
+
+    const auto* blocks = reinterpret_cast<const uint64_t*>(bytes + sizeof(file_header));
+
+    size_t total_blocks = (header.index_offset - sizeof(file_header)) / sizeof(uint64_t);
+
+    // the offsets have to ascend from the first to the last block
+    valid = !offsets[0] && offsets[header.count] == total_blocks;
+
+    for(size_t i1 = 0; valid && i1 < header.count; ++i1)
+        valid = offsets[i1] <= offsets[i1 + 1];
+
+    if(!valid)
+    {
+        close();
+
+        return false;
+    }
+
+    numbers.reserve(header.count);
+
+    for(size_t i1 = 0; i1 < header.count; ++i1)
+        numbers.emplace_back(blocks + offsets[i1], offsets[i1 + 1] - offsets[i1]);
+
+    return true;
+}
+
+
+void mapped_aint_file::close()
+{
+    // the numbers refer to the mapping and go first
+    numbers.clear();
+
+    numbers.shrink_to_fit();
+
+    if(mapping)
+        munmap(mapping, mapping_bytes);
+
+    mapping = nullptr;
+
+    mapping_bytes = 0;
+}
+
+
+bool mapped_aint_file::is_open() const
+{
+    return mapping != nullptr;
+}
+
+
+size_t mapped_aint_file::size() const
+{
+    return numbers.size();
+}
+
+
+const aint_view& mapped_aint_file::operator[](size_t index) const
+{
+    return numbers[index];
+}
@@ -0,0 +1,93 @@
+#ifndef AINT_AINT_FILE_H
+#define AINT_AINT_FILE_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include "aint.hpp"
+
+// binary container for many numbers (see aint_file.cpp for the layout)
+//
+// usage:
+//     aint_file_writer out{"numbers.aint"};
+//     out.write(a);
+//     out.write(b);
+//     out.close();
+//
+//     mapped_aint_file in{"numbers.aint"};
+//     aint sum = in[0] + in[1];
+
+
+// writes the numbers one after the other, the index is appended by close() or the destructor
+class aint_file_writer
+{
+public:
+
+    explicit aint_file_writer(const char*);
+
+    aint_file_writer(const aint_file_writer&) = delete;
+
+    aint_file_writer& operator=(const aint_file_writer&) = delete;
+
+    ~aint_file_writer();
+
+    // false if the file could not be opened or a write failed
+    bool good() const;
+
+    bool write(const aint&);
+
+    // completes the file with the index and the header, returns false if the file is not complete
+    bool close();
+
+private:
+
+    std::ofstream file;
+
+    // offsets of the numbers in blocks from the start of the blocks, the last entry is the end of the last number
+    std::vector<uint64_t> offsets{0};
+
+    bool closed = false;
+};
+
+
+// read-only access to the numbers of a file which is mapped into memory
+// the numbers are not copied, each of them is a view of its blocks inside the mapping, a copy is an ordinary aint with
+// its own storage
+// references to the numbers are valid until the file is closed
+class mapped_aint_file
+{
+public:
+
+    mapped_aint_file() = default;
+
+    explicit mapped_aint_file(const char*);
+
+    mapped_aint_file(const mapped_aint_file&) = delete;
+
+    mapped_aint_file& operator=(const mapped_aint_file&) = delete;
+
+    ~mapped_aint_file();
+
+    // false if the file cannot be mapped or is not a valid container, the object is closed then
+    bool open(const char*);
+
+    void close();
+
+    bool is_open() const;
+
+    size_t size() const;
+
+    const aint_view& operator[](size_t) const;
+
+private:
+
+    void* mapping = nullptr;
+
+    size_t mapping_bytes = 0;
+
+    std::vector<aint_view> numbers;
+};
+
+#endif //AINT_AINT_FILE_H
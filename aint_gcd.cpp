@@ -0,0 +1,315 @@
+/* Greatest common divisor
+ *
+ * kernel::gcd uses the algorithm of Lehmer (Knuth, The Art of Computer Programming, Vol. 2, 4.5.2, Algorithm L):
+ * the Euclidean algorithm is simulated on the leading 62 bits of both numbers in machine words as long as the
+ * quotients are guaranteed to be the same as for the full numbers. The steps are collected in a 2x2 cofactor matrix
+ * which is then applied to the full numbers at once with mul_1 and submul_1, replacing about 30 division steps by
+ * four passes over the numbers.
+ * If the simulation makes no progress, which happens when a quotient is too large, one full division step is done.
+ *
+ * Once the numbers fit into two limbs the binary algorithm of Stein takes over, which removes factors of two with
+ * a count trailing zeros instruction and otherwise only subtracts.
+ *
+ * Both numbers are copied into scratch arrays first and reduced there in place.
+ */
+#include "aint_kernels.hpp"
+
+using kernel::limb;
+using kernel::double_limb;
+
+
+// number of trailing zero bits of a non-zero double limb
+static size_t trailing_zeros(double_limb x)
+{
+    limb low = static_cast<limb>(x);
+
+    return low ? static_cast<size_t>(__builtin_ctzll(low))
+               : kernel::limb_bits + static_cast<size_t>(__builtin_ctzll(static_cast<limb>(x >> kernel::limb_bits)));
+}
+
+
+// binary gcd of two non-zero numbers
+static double_limb gcd_binary(double_limb u, double_limb v)
+{
+    size_t u_zeros = trailing_zeros(u);
+
+    size_t v_zeros = trailing_zeros(v);
+
+    size_t common = u_zeros < v_zeros ? u_zeros : v_zeros;
+
+    u >>= u_zeros;
+
+    // u and v stay odd, their difference is even and loses its factors of two right away
+    for(;;)
+    {
+        v >>= trailing_zeros(v);
+
+        if(u > v)
+        {
+            double_limb temp = u;
+
+            u = v;
+
+            v = temp;
+        }
+
+        v -= u;
+
+        if(!v)
+            return u << common;
+    }
+}
+
+
+// a = a mod b with an >= bn >= 1 where a has room for an + 1 limbs, returns the length of the remainder
+static size_t mod_reduce(limb* a, size_t an, const limb* b, size_t bn)
+{
+    if(bn == 1)
+    {
+        a[0] = kernel::mod_1(a, an, b[0]);
+
+        return a[0] ? 1 : 0;
+    }
+
+    // the division needs a divisor with its most significant bit set
+    size_t shift = kernel::limb_bits - kernel::significant_bits(b[bn - 1]);
+
+    kernel::scratch temp{an + 1};
+
+    limb* divisor = temp.get();
+
+    limb* quotient = divisor + bn;
+
+    if(shift)
+    {
+        kernel::lshift_n(divisor, b, bn, shift);
+
+        a[an] = kernel::lshift_n(a, a, an, shift);
+    }
+
+    else
+    {
+        for(size_t i1 = 0; i1 < bn; ++i1)
+            divisor[i1] = b[i1];
+
+        a[an] = 0;
+    }
+
+    kernel::div_qr(quotient, a, an + 1, divisor, bn);
+
+    if(shift)
+        kernel::rshift_n(a, a, bn, shift);
+
+    return kernel::normalized_size(a, bn);
+}
+
+
+// the 62 bits of a starting at bit position offset, a has n limbs
+static int64_t leading_bits(const limb* a, size_t n, size_t offset)
+{
+    size_t position = offset / kernel::limb_bits;
+
+    size_t shift = offset % kernel::limb_bits;
+
+    limb low = position < n ? a[position] >> shift : 0;
+
+    limb high = shift && position + 1 < n ? a[position + 1] << (kernel::limb_bits - shift) : 0;
+
+    return static_cast<int64_t>((low | high) & ((limb{1} << 62) - 1));
+}
+
+
+kernel::lehmer_matrix kernel::lehmer(const limb* u, size_t un, const limb* v, size_t vn)
+{
+    // the leading 62 bits of u and the bits of v at the same position
+    size_t offset = (un - 1) * limb_bits + significant_bits(u[un - 1]) - 62;
+
+    int64_t x = leading_bits(u, un, offset);
+
+    int64_t y = leading_bits(v, vn, offset);
+
+    // in the notation of Knuth the cofactors are A = a, B = b, C = c and D = d
+    lehmer_matrix matrix{};
+
+    while(y + matrix.c > 0 && y + matrix.d > 0)
+    {
+        int64_t q = (x + matrix.a) / (y + matrix.c);
+
+        // the quotient of the full numbers is only known if both bounds agree
+        if(q != (x + matrix.b) / (y + matrix.d))
+            break;
+
+        int64_t temp = matrix.a - q * matrix.c;
+
+        matrix.a = matrix.c;
+
+        matrix.c = temp;
+
+        temp = matrix.b - q * matrix.d;
+
+        matrix.b = matrix.d;
+
+        matrix.d = temp;
+
+        temp = x - q * y;
+
+        x = y;
+
+        y = temp;
+
+        ++matrix.steps;
+    }
+
+    return matrix;
+}
+
+
+size_t kernel::cofactor_combine(limb* r, const limb* u, size_t un, int64_t x, const limb* v, size_t vn, int64_t y,
+                                size_t n)
+{
+    // the positive product is written first and the negative one subtracted from it
+    const limb* positive = y <= 0 ? u : v;
+
+    const limb* negative = y <= 0 ? v : u;
+
+    size_t positive_size = y <= 0 ? un : vn;
+
+    size_t negative_size = y <= 0 ? vn : un;
+
+    limb positive_factor = static_cast<limb>(y <= 0 ? x : y);
+
+    limb negative_factor = static_cast<limb>(y <= 0 ? -y : -x);
+
+    limb carry = mul_1(r, positive, positive_size, positive_factor);
+
+    // carries beyond n limbs cancel since the result fits into n limbs
+    for(size_t i1 = positive_size; i1 < n; ++i1)
+    {
+        r[i1] = carry;
+
+        carry = 0;
+    }
+
+    limb borrow = submul_1(r, negative, negative_size, negative_factor);
+
+    sub_1(r + negative_size, r + negative_size, n - negative_size, borrow);
+
+    return normalized_size(r, n);
+}
+
+
+size_t kernel::gcd(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    size_t n = an > bn ? an : bn;
+
+    // the two numbers and the results of applying a cofactor matrix, each with one spare limb for the division
+    kernel::scratch temp{4 * (n + 1)};
+
+    limb* u = temp.get();
+
+    limb* v = u + (n + 1);
+
+    limb* u_next = v + (n + 1);
+
+    limb* v_next = u_next + (n + 1);
+
+    size_t un = an;
+
+    size_t vn = bn;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        u[i1] = i1 < an ? a[i1] : 0;
+
+        v[i1] = i1 < bn ? b[i1] : 0;
+    }
+
+    for(;;)
+    {
+        // u is kept as the larger number
+        if(cmp(u, un, v, vn) < 0)
+        {
+            limb* temp_ptr = u;
+
+            u = v;
+
+            v = temp_ptr;
+
+            size_t temp_size = un;
+
+            un = vn;
+
+            vn = temp_size;
+        }
+
+        if(vn <= 2)
+            break;
+
+        // the matrix can only be computed from numbers of about the same length
+        if(un > vn + 1)
+        {
+            un = mod_reduce(u, un, v, vn);
+
+            continue;
+        }
+
+        lehmer_matrix matrix = lehmer(u, un, v, vn);
+
+        if(!matrix.steps)
+        {
+            un = mod_reduce(u, un, v, vn);
+
+            continue;
+        }
+
+        size_t u_size = cofactor_combine(u_next, u, un, matrix.a, v, vn, matrix.b, un);
+
+        size_t v_size = cofactor_combine(v_next, u, un, matrix.c, v, vn, matrix.d, un);
+
+        limb* temp_ptr = u;
+
+        u = u_next;
+
+        u_next = temp_ptr;
+
+        temp_ptr = v;
+
+        v = v_next;
+
+        v_next = temp_ptr;
+
+        un = u_size;
+
+        vn = v_size;
+    }
+
+    if(!vn)
+    {
+        for(size_t i1 = 0; i1 < un; ++i1)
+            r[i1] = u[i1];
+
+        return un;
+    }
+
+    // the larger number is reduced to the size of the smaller one before the binary algorithm finishes
+    if(un > 2)
+        un = mod_reduce(u, un, v, vn);
+
+    double_limb small_u = un ? (un > 1 ? static_cast<double_limb>(u[1]) << limb_bits : 0) | u[0] : 0;
+
+    double_limb small_v = (vn > 1 ? static_cast<double_limb>(v[1]) << limb_bits : 0) | v[0];
+
+    double_limb result = small_u ? gcd_binary(small_u, small_v) : small_v;
+
+    r[0] = static_cast<limb>(result);
+
+    // a gcd of two limbs requires both numbers to have at least two limbs
+    if(result >> limb_bits)
+    {
+        r[1] = static_cast<limb>(result >> limb_bits);
+
+        return 2;
+    }
+
+    return 1;
+}
@@ -0,0 +1,496 @@
+/* Half gcd
+ *
+ * Lehmer's algorithm (aint_gcd.cpp) still needs a quadratic number of operations since every cofactor matrix only
+ * covers one machine word of quotients. For large numbers gcd() uses the recursive half gcd of Schoenhage in the form
+ * of Moller (On Schoenhage's algorithm and subquadratic integer gcd computation, 2008) and GMP (mpn_hgcd):
+ *
+ * hgcd(a, b) reduces two numbers of n blocks by steps of the Euclidean algorithm as long as both stay longer than
+ * s = n / 2 + 1 blocks and returns the matrix M of the steps with (a, b) = M (a', b'). The steps only depend on the
+ * upper half of the numbers, so hgcd first calls itself on the upper n / 2 blocks, applies the matrix of this call to
+ * the full numbers, does single steps until 3/4 n blocks are left and then calls itself once more on the upper part
+ * of the remaining numbers. The matrices are multiplied with the fast multiplication, so hgcd costs O(M(n) log n)
+ * and so does the gcd, which calls hgcd on the upper third of its numbers until they are small enough for Lehmer.
+ *
+ * A single step stops before one of the numbers or their difference falls to s blocks or below. Below
+ * kernel::thresholds.hgcd the steps are taken from Lehmer's cofactor matrices as long as the reduced numbers stay
+ * above s blocks, otherwise one full division is done.
+ *
+ * xgcd() runs the same reduction down to (g, 0) but keeps the product M of all matrices, so (a, b) = M (g, 0) and
+ * the inverse of M holds the Bezout coefficients. Since M only has non-negative entries and the sign of the
+ * coefficients follows from its determinant, the unsigned aint is enough. The coefficients are finally brought into
+ * the range 0 < s <= b / g with one division of two entries of M.
+ * A modular inverse is the coefficient s of xgcd(a mod m, m), and many inverses under the same modulus share a single
+ * xgcd by the trick of Montgomery: the inverse of the product of all numbers is multiplied back with the products of
+ * all other numbers, which costs three multiplications modulo m per number.
+ */
+#include "aint.hpp"
+
+
+// 2x2 matrix of non-negative numbers with the determinant det = 1 or -1 which relates the numbers at the start of a
+// reduction to the reduced numbers, (a, b) = M (a', b')
+struct gcd_matrix
+{
+    aint m[2][2];
+
+    int det = 1;
+
+    gcd_matrix()
+    {
+        m[0][0] = 1;
+
+        m[1][1] = 1;
+    }
+};
+
+
+class half_gcd
+{
+public:
+
+    // gcd of two non-zero numbers, if M is not nullptr it is multiplied by the matrix of all steps, (a, b) = M (g, 0)
+    static aint gcd(aint, aint, gcd_matrix* M);
+
+    // the same with Lehmer's algorithm
+    static aint gcd_lehmer(const aint&, const aint&);
+
+private:
+
+    static size_t size(const aint& a, const aint& b)
+    {
+        return a.number_blocks > b.number_blocks ? a.number_blocks : b.number_blocks;
+    }
+
+    // M = M M1
+    static void multiply(gcd_matrix& M, const gcd_matrix& M1);
+
+    // swaps a and b and with them the columns of M
+    static void exchange(aint& a, aint& b, gcd_matrix* M);
+
+    static bool lehmer_step(aint& a, aint& b, size_t s, gcd_matrix* M);
+
+    static bool step(aint& a, aint& b, size_t s, gcd_matrix* M);
+
+    static bool reduce(aint& a, aint& b, size_t p, gcd_matrix* M);
+
+    static bool hgcd(aint& a, aint& b, gcd_matrix& M);
+};
+
+
+void half_gcd::multiply(gcd_matrix& M, const gcd_matrix& M1)
+{
+    for(size_t i1 = 0; i1 < 2; ++i1)
+    {
+        aint first = M.m[i1][0] * M1.m[0][0] + M.m[i1][1] * M1.m[1][0];
+
+        aint second = M.m[i1][0] * M1.m[0][1] + M.m[i1][1] * M1.m[1][1];
+
+        M.m[i1][0].swap(first);
+
+        M.m[i1][1].swap(second);
+    }
+
+    M.det *= M1.det;
+}
+
+
+void half_gcd::exchange(aint& a, aint& b, gcd_matrix* M)
+{
+    a.swap(b);
+
+    if(M)
+    {
+        M->m[0][0].swap(M->m[0][1]);
+
+        M->m[1][0].swap(M->m[1][1]);
+
+        M->det = -M->det;
+    }
+}
+
+
+// several steps at once with a cofactor matrix of Lehmer's algorithm for a >= b, all of its steps are valid as long
+// as the smaller of the reduced numbers is still longer than s blocks, since the differences of consecutive numbers
+// of the remainder sequence are at least as large
+bool half_gcd::lehmer_step(aint& a, aint& b, size_t s, gcd_matrix* M)
+{
+    if(a.number_blocks < 2 || a.number_blocks > b.number_blocks + 1)
+        return false;
+
+    kernel::lehmer_matrix matrix = kernel::lehmer(a.storage, a.number_blocks, b.storage, b.number_blocks);
+
+    if(!matrix.steps)
+        return false;
+
+    aint u{};
+
+    aint v{};
+
+    u.reserve(a.number_blocks);
+
+    v.reserve(a.number_blocks);
+
+    u.number_blocks = kernel::cofactor_combine(u.storage, a.storage, a.number_blocks, matrix.a, b.storage,
+                                               b.number_blocks, matrix.b, a.number_blocks);
+
+    v.number_blocks = kernel::cofactor_combine(v.storage, a.storage, a.number_blocks, matrix.c, b.storage,
+                                               b.number_blocks, matrix.d, a.number_blocks);
+
+    if(v.number_blocks <= s)
+        return false;
+
+    u.normalize();
+
+    v.normalize();
+
+    a.swap(u);
+
+    b.swap(v);
+
+    if(M)
+    {
+        // the inverse of the cofactor matrix has the absolute values of its entries
+        uint64_t inverse[2][2] = {{static_cast<uint64_t>(matrix.d < 0 ? -matrix.d : matrix.d),
+                                   static_cast<uint64_t>(matrix.b < 0 ? -matrix.b : matrix.b)},
+                                  {static_cast<uint64_t>(matrix.c < 0 ? -matrix.c : matrix.c),
+                                   static_cast<uint64_t>(matrix.a < 0 ? -matrix.a : matrix.a)}};
+
+        for(size_t i1 = 0; i1 < 2; ++i1)
+        {
+            aint first = M->m[i1][0] * inverse[0][0] + M->m[i1][1] * inverse[1][0];
+
+            aint second = M->m[i1][0] * inverse[0][1] + M->m[i1][1] * inverse[1][1];
+
+            M->m[i1][0].swap(first);
+
+            M->m[i1][1].swap(second);
+        }
+
+        if(matrix.steps % 2)
+            M->det = -M->det;
+    }
+
+    return true;
+}
+
+
+// one or more steps of the Euclidean algorithm which keep a, b and their difference longer than s blocks (or non-zero
+// for s = 0), returns false if not even one step is possible, M may be nullptr if the matrix is not needed
+bool half_gcd::step(aint& a, aint& b, size_t s, gcd_matrix* M)
+{
+    // a is kept as the larger number
+    if(a < b)
+        exchange(a, b, M);
+
+    if(b.number_blocks <= s || a == b)
+        return false;
+
+    if(lehmer_step(a, b, s, M))
+        return true;
+
+    if(s && (a - b).number_blocks <= s)
+        return false;
+
+    aint quotient{};
+
+    aint remainder{};
+
+    divmod(a, b, quotient, remainder);
+
+    // the quotient is one too large for the stopping condition, a - (q - 1) b is still longer than s blocks
+    if(s && remainder.number_blocks <= s)
+    {
+        quotient -= 1;
+
+        remainder += b;
+    }
+
+    a.swap(remainder);
+
+    if(M)
+    {
+        // a - q b adds q times the first column of M to the second
+        M->m[0][1] += quotient * M->m[0][0];
+
+        M->m[1][1] += quotient * M->m[1][0];
+    }
+
+    return true;
+}
+
+
+// reduces a and b by a half gcd of their blocks above the lower p blocks, returns false if no step was possible
+bool half_gcd::reduce(aint& a, aint& b, size_t p, gcd_matrix* M)
+{
+    aint a_high{aint_view{a}.high(p)};
+
+    aint b_high{aint_view{b}.high(p)};
+
+    gcd_matrix M1{};
+
+    if(!hgcd(a_high, b_high, M1))
+        return false;
+
+    // (a', b') = M1^-1 (a, b) where the upper blocks are already reduced to a_high and b_high
+    // the lower blocks are read in place, so a and b are only replaced once both results are complete
+    aint_view a_low = aint_view{a}.low(p);
+
+    aint_view b_low = aint_view{b}.low(p);
+
+    aint positive = M1.m[1][1] * a_low;
+
+    aint negative = M1.m[0][1] * b_low;
+
+    if(M1.det < 0)
+        positive.swap(negative);
+
+    aint a_reduced = (a_high << (p * aint::block_bits)) + positive - negative;
+
+    positive = M1.m[0][0] * b_low;
+
+    negative = M1.m[1][0] * a_low;
+
+    if(M1.det < 0)
+        positive.swap(negative);
+
+    aint b_reduced = (b_high << (p * aint::block_bits)) + positive - negative;
+
+    a.swap(a_reduced);
+
+    b.swap(b_reduced);
+
+    if(M)
+        multiply(*M, M1);
+
+    return true;
+}
+
+
+// reduces a and b of n blocks as long as both stay longer than s = n / 2 + 1 blocks and multiplies M by the matrix of
+// the steps, returns false if not even one step was possible
+bool half_gcd::hgcd(aint& a, aint& b, gcd_matrix& M)
+{
+    size_t n = size(a, b);
+
+    size_t s = n / 2 + 1;
+
+    if(n <= s)
+        return false;
+
+    bool success = false;
+
+    if(n >= kernel::thresholds.hgcd)
+    {
+        size_t quarter = (3 * n) / 4 + 1;
+
+        // the upper half reduces the numbers to about 3/4 n blocks
+        if(reduce(a, b, n / 2, &M))
+            success = true;
+
+        while(size(a, b) > quarter)
+        {
+            if(!step(a, b, s, &M))
+                return success;
+
+            success = true;
+        }
+
+        // the upper part of the remaining numbers reduces them to about n / 2 blocks
+        n = size(a, b);
+
+        if(n > s + 2 && reduce(a, b, 2 * s - n + 1, &M))
+            success = true;
+    }
+
+    while(step(a, b, s, &M))
+        success = true;
+
+    return success;
+}
+
+
+aint half_gcd::gcd(aint a, aint b, gcd_matrix* M)
+{
+    for(;;)
+    {
+        if(a < b)
+            exchange(a, b, M);
+
+        if(b.zero())
+            return a;
+
+        // without cofactors the small numbers are left to Lehmer's algorithm on the blocks
+        if(!M && b.number_blocks < kernel::thresholds.gcd_dc)
+            return gcd_lehmer(a, b);
+
+        // the last step a - b = 0 adds the second column of M to the first
+        if(a == b)
+        {
+            if(M)
+            {
+                M->m[0][0] += M->m[0][1];
+
+                M->m[1][0] += M->m[1][1];
+            }
+
+            return a;
+        }
+
+        // the upper third of the blocks removes about a sixth of them, numbers of different length are first
+        // brought to the same length by a division step
+        size_t n = a.number_blocks;
+
+        if(b.number_blocks == n && n >= kernel::thresholds.gcd_dc && reduce(a, b, (2 * n) / 3, M))
+            continue;
+
+        step(a, b, 0, M);
+    }
+}
+
+
+aint half_gcd::gcd_lehmer(const aint& a, const aint& b)
+{
+    size_t length = a.number_blocks < b.number_blocks ? a.number_blocks : b.number_blocks;
+
+    aint result{};
+
+    result.reserve(length);
+
+    result.number_blocks = kernel::gcd(result.storage, a.storage, a.number_blocks, b.storage, b.number_blocks);
+
+    result.normalize();
+
+    return result;
+}
+
+
+// greatest common divisor of two numbers
+aint gcd(const aint& a, const aint& b)
+{
+    if(a.zero())
+        return b;
+
+    if(b.zero())
+        return a;
+
+    if(a.number_blocks < kernel::thresholds.gcd_dc || b.number_blocks < kernel::thresholds.gcd_dc)
+        return half_gcd::gcd_lehmer(a, b);
+
+    return half_gcd::gcd(a, b, nullptr);
+}
+
+
+aint xgcd(const aint& a, const aint& b, aint& s, aint& t)
+{
+    if(a.zero())
+    {
+        s = 0;
+
+        t = 0;
+
+        return b;
+    }
+
+    if(b.zero())
+    {
+        s = 1;
+
+        t = 0;
+
+        return a;
+    }
+
+    gcd_matrix M{};
+
+    aint g = half_gcd::gcd(a, b, &M);
+
+    // (g, 0) = M^-1 (a, b) gives g = det (m11 a - m01 b), and a / g = m00 and b / g = m10
+    // the coefficients are shifted by multiples of (b / g, a / g) until s is in 0 < s <= b / g
+    aint quotient{};
+
+    aint remainder{};
+
+    divmod(M.m[1][1], M.m[1][0], quotient, remainder);
+
+    if(M.det > 0)
+    {
+        if(remainder.zero())
+        {
+            s = M.m[1][0];
+
+            t = M.m[0][1] + M.m[0][0] - quotient * M.m[0][0];
+        }
+
+        else
+        {
+            s = remainder;
+
+            t = M.m[0][1] - quotient * M.m[0][0];
+        }
+    }
+
+    else
+    {
+        s = M.m[1][0] - remainder;
+
+        t = (quotient + 1) * M.m[0][0] - M.m[0][1];
+    }
+
+    return g;
+}
+
+
+aint modinv(const aint& a, const aint& m)
+{
+    if(m.zero())
+        return aint{};
+
+    aint s{};
+
+    aint t{};
+
+    if(xgcd(a % m, m, s, t) != 1)
+        return aint{};
+
+    // s = m only for m = 1
+    return s % m;
+}
+
+
+std::vector<aint> modinv(const std::vector<aint>& values, const aint& m)
+{
+    std::vector<aint> result(values.size());
+
+    if(values.empty() || m.zero())
+        return result;
+
+    // products[i1] is the product of the first i1 + 1 numbers modulo m
+    std::vector<aint> products(values.size());
+
+    products[0] = values[0] % m;
+
+    for(size_t i1 = 1; i1 < values.size(); ++i1)
+        products[i1] = products[i1 - 1] * values[i1] % m;
+
+    aint inverse = modinv(products.back(), m);
+
+    // one of the numbers is not invertible, the others are still inverted one by one
+    if(inverse.zero())
+    {
+        for(size_t i1 = 0; i1 < values.size(); ++i1)
+            result[i1] = modinv(values[i1], m);
+
+        return result;
+    }
+
+    // inverse is the inverse of the product of the first i1 + 1 numbers
+    for(size_t i1 = values.size() - 1; i1 > 0; --i1)
+    {
+        result[i1] = inverse * products[i1 - 1] % m;
+
+        inverse = inverse * values[i1] % m;
+    }
+
+    result[0] = inverse;
+
+    return result;
+}
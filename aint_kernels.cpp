@@ -0,0 +1,356 @@
+#include "aint_kernels.hpp"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+using kernel::limb;
+using kernel::double_limb;
+
+kernel::tuning kernel::thresholds{};
+
+
+int kernel::cmp_n(const limb* a, const limb* b, size_t n)
+{
+    for(size_t i1 = n; i1 > 0; --i1)
+    {
+        if(a[i1 - 1] != b[i1 - 1])
+            return a[i1 - 1] < b[i1 - 1] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+
+int kernel::cmp(const limb* a, size_t an, const limb* b, size_t bn)
+{
+    if(an != bn)
+        return an < bn ? -1 : 1;
+
+    return cmp_n(a, b, an);
+}
+
+
+limb kernel::add_n(limb* r, const limb* a, const limb* b, size_t n)
+{
+#if defined(__x86_64__)
+    // unrolled by four so the carry stays in the flags register
+    unsigned char carry = 0;
+
+    unsigned long long res_0, res_1, res_2, res_3;
+
+    size_t i1 = 0;
+
+    for(; i1 + 4 <= n; i1 += 4)
+    {
+        carry = _addcarry_u64(carry, a[i1], b[i1], &res_0);
+
+        carry = _addcarry_u64(carry, a[i1 + 1], b[i1 + 1], &res_1);
+
+        carry = _addcarry_u64(carry, a[i1 + 2], b[i1 + 2], &res_2);
+
+        carry = _addcarry_u64(carry, a[i1 + 3], b[i1 + 3], &res_3);
+
+        r[i1] = res_0;
+
+        r[i1 + 1] = res_1;
+
+        r[i1 + 2] = res_2;
+
+        r[i1 + 3] = res_3;
+    }
+
+    for(; i1 < n; ++i1)
+    {
+        carry = _addcarry_u64(carry, a[i1], b[i1], &res_0);
+
+        r[i1] = res_0;
+    }
+
+    return carry;
+#else
+    double_limb add_res = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        add_res += a[i1];
+
+        add_res += b[i1];
+
+        // intended cropping when converting to limb
+        r[i1] = static_cast<limb>(add_res);
+
+        add_res >>= limb_bits;
+    }
+
+    return static_cast<limb>(add_res);
+#endif
+}
+
+
+limb kernel::add_1(limb* r, const limb* a, size_t n, limb b)
+{
+    size_t i1 = 0;
+
+    // the carry usually dies out after the first limb
+    for(; i1 < n && b; ++i1)
+    {
+        limb sum = a[i1] + b;
+
+        b = (sum < b);
+
+        r[i1] = sum;
+    }
+
+    if(r != a)
+    {
+        for(; i1 < n; ++i1)
+            r[i1] = a[i1];
+    }
+
+    return b;
+}
+
+
+limb kernel::add(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    limb carry = bn ? add_n(r, a, b, bn) : 0;
+
+    return add_1(r + bn, a + bn, an - bn, carry);
+}
+
+
+limb kernel::sub_n(limb* r, const limb* a, const limb* b, size_t n)
+{
+#if defined(__x86_64__)
+    // unrolled by four so the borrow stays in the flags register
+    unsigned char borrow = 0;
+
+    unsigned long long res_0, res_1, res_2, res_3;
+
+    size_t i1 = 0;
+
+    for(; i1 + 4 <= n; i1 += 4)
+    {
+        borrow = _subborrow_u64(borrow, a[i1], b[i1], &res_0);
+
+        borrow = _subborrow_u64(borrow, a[i1 + 1], b[i1 + 1], &res_1);
+
+        borrow = _subborrow_u64(borrow, a[i1 + 2], b[i1 + 2], &res_2);
+
+        borrow = _subborrow_u64(borrow, a[i1 + 3], b[i1 + 3], &res_3);
+
+        r[i1] = res_0;
+
+        r[i1 + 1] = res_1;
+
+        r[i1 + 2] = res_2;
+
+        r[i1 + 3] = res_3;
+    }
+
+    for(; i1 < n; ++i1)
+    {
+        borrow = _subborrow_u64(borrow, a[i1], b[i1], &res_0);
+
+        r[i1] = res_0;
+    }
+
+    return borrow;
+#else
+    limb borrow = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        limb difference = a[i1] - b[i1] - borrow;
+
+        borrow = (a[i1] < b[i1]) || (a[i1] - b[i1] < borrow);
+
+        r[i1] = difference;
+    }
+
+    return borrow;
+#endif
+}
+
+
+limb kernel::sub_1(limb* r, const limb* a, size_t n, limb b)
+{
+    size_t i1 = 0;
+
+    // the borrow usually dies out after the first limb
+    for(; i1 < n && b; ++i1)
+    {
+        limb difference = a[i1] - b;
+
+        b = (a[i1] < b);
+
+        r[i1] = difference;
+    }
+
+    if(r != a)
+    {
+        for(; i1 < n; ++i1)
+            r[i1] = a[i1];
+    }
+
+    return b;
+}
+
+
+limb kernel::sub(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    limb borrow = bn ? sub_n(r, a, b, bn) : 0;
+
+    return sub_1(r + bn, a + bn, an - bn, borrow);
+}
+
+
+limb kernel::mul_1(limb* r, const limb* a, size_t n, limb b)
+{
+    limb carry = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        double_limb mult_res = static_cast<double_limb>(a[i1]) * b + carry;
+
+        // intended cropping when converting to limb
+        r[i1] = static_cast<limb>(mult_res);
+
+        carry = static_cast<limb>(mult_res >> limb_bits);
+    }
+
+    return carry;
+}
+
+
+limb kernel::addmul_1(limb* r, const limb* a, size_t n, limb b)
+{
+    // the carry always fits into a single limb since (2^64 - 1) * (2^64 - 1) + 2 * (2^64 - 1) = 2^128 - 1
+    limb carry = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        double_limb mult_res = static_cast<double_limb>(a[i1]) * b + r[i1] + carry;
+
+        // intended cropping when converting to limb
+        r[i1] = static_cast<limb>(mult_res);
+
+        carry = static_cast<limb>(mult_res >> limb_bits);
+    }
+
+    return carry;
+}
+
+
+limb kernel::submul_1(limb* r, const limb* a, size_t n, limb b)
+{
+    limb carry = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        double_limb mult_res = static_cast<double_limb>(a[i1]) * b + carry;
+
+        limb low = static_cast<limb>(mult_res);
+
+        carry = static_cast<limb>(mult_res >> limb_bits) + (r[i1] < low);
+
+        r[i1] -= low;
+    }
+
+    return carry;
+}
+
+
+limb kernel::lshift_n(limb* r, const limb* a, size_t n, size_t shifts)
+{
+    // a shift by the full limb width would be undefined, no shift is a copy from the top
+    if(!shifts)
+    {
+        for(size_t i1 = n; i1 > 0; --i1)
+            r[i1 - 1] = a[i1 - 1];
+
+        return 0;
+    }
+
+    size_t counter_shifts = limb_bits - shifts;
+
+    limb out = a[n - 1] >> counter_shifts;
+
+    // from the most significant limb down so r may lie above a
+    for(size_t i1 = n - 1; i1 > 0; --i1)
+        r[i1] = (a[i1] << shifts) | (a[i1 - 1] >> counter_shifts);
+
+    r[0] = a[0] << shifts;
+
+    return out;
+}
+
+
+limb kernel::rshift_n(limb* r, const limb* a, size_t n, size_t shifts)
+{
+    if(!shifts)
+    {
+        for(size_t i1 = 0; i1 < n; ++i1)
+            r[i1] = a[i1];
+
+        return 0;
+    }
+
+    size_t counter_shifts = limb_bits - shifts;
+
+    limb out = a[0] << counter_shifts;
+
+    // from the least significant limb up so r may lie below a
+    for(size_t i1 = 0; i1 + 1 < n; ++i1)
+        r[i1] = (a[i1] >> shifts) | (a[i1 + 1] << counter_shifts);
+
+    r[n - 1] = a[n - 1] >> shifts;
+
+    return out;
+}
+
+
+void kernel::mul_basecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    // the first row initialises the result, every further row is accumulated on top of it
+    r[an] = mul_1(r, a, an, b[0]);
+
+    for(size_t i1 = 1; i1 < bn; ++i1)
+        r[an + i1] = addmul_1(r + i1, a, an, b[i1]);
+}
+
+
+void kernel::divexact_by3(limb* r, const limb* a, size_t n)
+{
+    // Hensel division: multiplying by the inverse of 3 modulo 2^64 yields the quotient limb by limb
+    // as long as the borrow of 3 * quotient is carried on into the next limb
+    const limb inverse = 0xAAAAAAAAAAAAAAABull;
+
+    limb borrow = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        limb dividend = a[i1] - borrow;
+
+        limb next_borrow = (a[i1] < borrow);
+
+        limb quotient = dividend * inverse;
+
+        r[i1] = quotient;
+
+        borrow = static_cast<limb>((static_cast<double_limb>(quotient) * 3) >> limb_bits) + next_borrow;
+    }
+}
+
+
+kernel::scratch::scratch(size_t size) : blocks(size ? size : 1)
+{
+    ptr = block_allocator::acquire(blocks, owner);
+}
+
+
+kernel::scratch::~scratch()
+{
+    block_allocator::give_back(ptr, blocks, owner);
+}
@@ -0,0 +1,219 @@
+#ifndef AINT_AINT_KERNELS_H
+#define AINT_AINT_KERNELS_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include "aint_alloc.hpp"
+
+// low level arithmetic on raw arrays of blocks ("limbs")
+// all arrays are stored from the least to the most significant limb like the storage of aint
+// lengths are given in limbs and have to be > 0 unless stated otherwise
+// a result array may be identical to an input array but must not partially overlap it unless stated otherwise
+namespace kernel
+{
+    using limb = uint64_t;
+
+    using double_limb = unsigned __int128;
+
+    constexpr size_t limb_bits = 64;
+
+    // number of significant bits of a non-zero limb
+    inline size_t significant_bits(limb x)
+    {
+        return limb_bits - static_cast<size_t>(__builtin_clzll(x));
+    }
+
+    // length of a after stripping leading zero limbs, may be 0
+    inline size_t normalized_size(const limb* a, size_t n)
+    {
+        while(n && !a[n - 1])
+            --n;
+
+        return n;
+    }
+
+    // -1, 0 or 1 if a is smaller, equal or larger than b, both of length n (n may be 0)
+    int cmp_n(const limb* a, const limb* b, size_t n);
+
+    // compares two normalized numbers of possibly different length
+    int cmp(const limb* a, size_t an, const limb* b, size_t bn);
+
+    // r = a + b, returns the carry
+    limb add_n(limb* r, const limb* a, const limb* b, size_t n);
+
+    // r = a + b with an >= bn, returns the carry (bn may be 0)
+    limb add(limb* r, const limb* a, size_t an, const limb* b, size_t bn);
+
+    // r = a + b for a single limb b, returns the carry
+    limb add_1(limb* r, const limb* a, size_t n, limb b);
+
+    // r = a - b, returns the borrow
+    limb sub_n(limb* r, const limb* a, const limb* b, size_t n);
+
+    // r = a - b with an >= bn, returns the borrow (bn may be 0)
+    limb sub(limb* r, const limb* a, size_t an, const limb* b, size_t bn);
+
+    // r = a - b for a single limb b, returns the borrow
+    limb sub_1(limb* r, const limb* a, size_t n, limb b);
+
+    // r = a * b for a single limb b, returns the most significant limb of the product
+    limb mul_1(limb* r, const limb* a, size_t n, limb b);
+
+    // r += a * b for a single limb b, returns the carry
+    limb addmul_1(limb* r, const limb* a, size_t n, limb b);
+
+    // r -= a * b for a single limb b, returns the borrow
+    limb submul_1(limb* r, const limb* a, size_t n, limb b);
+
+    // r = a << shifts with shifts < limb_bits, returns the bits shifted out
+    // r may overlap a as long as r >= a
+    limb lshift_n(limb* r, const limb* a, size_t n, size_t shifts);
+
+    // r = a >> shifts with shifts < limb_bits, returns the bits shifted out in the most significant positions
+    // r may overlap a as long as r <= a
+    limb rshift_n(limb* r, const limb* a, size_t n, size_t shifts);
+
+    // exact division r = a / 3, a has to be a multiple of 3
+    void divexact_by3(limb* r, const limb* a, size_t n);
+
+    // r = a * b with an >= bn, r has an + bn limbs and must not overlap a or b
+    void mul_basecase(limb* r, const limb* a, size_t an, const limb* b, size_t bn);
+
+    // r = a * b with an >= bn, chooses the algorithm by the size of the operands
+    // r has an + bn limbs and must not overlap a or b
+    void mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn);
+
+    // r = a^2, r has 2n limbs and must not overlap a
+    void sqr_basecase(limb* r, const limb* a, size_t n);
+
+    // r = a^2, chooses the algorithm by the size of the operand
+    // r has 2n limbs and must not overlap a
+    void sqr(limb* r, const limb* a, size_t n);
+
+    // q = a / d for a single limb d != 0, q has n limbs and may be identical to a, returns the remainder
+    limb divrem_1(limb* q, const limb* a, size_t n, limb d);
+
+    // a mod d for a single limb d != 0, n may be 0
+    limb mod_1(const limb* a, size_t n, limb d);
+
+    // single limb divisor with its reciprocal for repeated divisions by the same limb
+    struct limb_divisor
+    {
+        explicit limb_divisor(limb);
+
+        limb value;
+
+        // d shifted until its most significant bit is set and the shift
+        size_t shift = 0;
+
+        limb normalized = 0;
+
+        limb reciprocal = 0;
+    };
+
+    // the same as divrem_1 with two multiplications instead of a division per limb, d.value must not be 0
+    limb divrem_1_preinv(limb* q, const limb* a, size_t n, const limb_divisor& d);
+
+    // schoolbook division of n by d with nn >= dn >= 2 where the most significant bit of d[dn - 1] has to be set
+    // q receives the nn - dn low limbs of the quotient, the remainder replaces the low dn limbs of n and the upper
+    // limbs of n are set to zero, returns the most significant limb of the quotient which is 0 or 1
+    // q must not overlap n or d
+    limb div_qr_basecase(limb* q, limb* n, size_t nn, const limb* d, size_t dn);
+
+    // the same division choosing the algorithm by the size of the operands, the upper limbs of n are undefined
+    // afterwards
+    limb div_qr(limb* q, limb* n, size_t nn, const limb* d, size_t dn);
+
+    // cofactors of one step of Lehmer's algorithm: u' = a u + b v and v' = c u + d v
+    // a and b as well as c and d have opposite signs or one of them is zero, the determinant is (-1)^steps
+    struct lehmer_matrix
+    {
+        int64_t a = 1;
+
+        int64_t b = 0;
+
+        int64_t c = 0;
+
+        int64_t d = 1;
+
+        size_t steps = 0;
+    };
+
+    // runs the Euclidean algorithm on the leading 62 bits of u >= v as long as the quotients are the same as those
+    // of the full numbers (Knuth's Algorithm L), requires un >= 2 and vn >= un - 1, returns steps = 0 if not even
+    // the first quotient is certain
+    lehmer_matrix lehmer(const limb* u, size_t un, const limb* v, size_t vn);
+
+    // r = x u + y v for x and y of opposite signs (or one of them zero) where the result is known to be
+    // non-negative and to fit into n >= un, vn limbs, returns the length of r
+    size_t cofactor_combine(limb* r, const limb* u, size_t un, int64_t x, const limb* v, size_t vn, int64_t y,
+                            size_t n);
+
+    // r = gcd(a, b) for non-zero a and b, r has as many limbs as the shorter number, returns the length of r
+    size_t gcd(limb* r, const limb* a, size_t an, const limb* b, size_t bn);
+
+    // operand sizes in limbs from which on the faster algorithms are used
+    // the values are global and not synchronised, they are meant to be tuned once at program start
+    // every value is allowed down to 0, the algorithms are still only used from the smallest size they can split:
+    // 2 limbs for Karatsuba, 3 for Toom-Cook, 4 for the recursive division and 20 digits for the decimal conversion
+    struct tuning
+    {
+        // below this size of the shorter operand the schoolbook method is used
+        size_t mul_karatsuba = 32;
+
+        // below this size of the shorter operand Karatsuba is used, above it Toom-Cook 3-way
+        size_t mul_toom3 = 100;
+
+        // from this size of the shorter operand on the number theoretic transform is used, for squares as well
+        size_t mul_ntt = 20000;
+
+        // the same crossovers for squares
+        size_t sqr_karatsuba = 64;
+
+        size_t sqr_toom3 = 200;
+
+        // below this size of the divisor or the quotient the schoolbook division is used
+        size_t div_dc = 40;
+
+        // below this size of the numbers the half gcd only takes single steps instead of recursing
+        size_t hgcd = 100;
+
+        // from this size of the shorter number on gcd uses the half gcd instead of Lehmer's algorithm
+        size_t gcd_dc = 300;
+
+        // below this size decimal text is converted 19 digits at a time instead of by divide and conquer
+        size_t radix_dc = 30;
+    };
+
+    extern tuning thresholds;
+
+    // temporary array of limbs taken from the allocator of the calling thread for the lifetime of the object
+    class scratch
+    {
+    public:
+
+        explicit scratch(size_t);
+
+        scratch(const scratch&) = delete;
+
+        scratch& operator=(const scratch&) = delete;
+
+        ~scratch();
+
+        limb* get() const
+        {
+            return ptr;
+        }
+
+    private:
+
+        size_t blocks;
+
+        block_allocator* owner = nullptr;
+
+        limb* ptr;
+    };
+}
+
+#endif //AINT_AINT_KERNELS_H
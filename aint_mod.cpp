@@ -0,0 +1,245 @@
+/* Modular arithmetic with a fixed modulus
+ *
+ * Reducing many numbers by the same m costs a full division each time with operator%. A modulus object computes
+ * the constants of two division free reductions once and reuses them for every number.
+ *
+ * Barrett's method works for every m of n blocks with the reciprocal mu = floor(B^(2n) / m) where B = 2^64. For
+ * a < B^(2n) the quotient estimate q = floor(floor(a / B^(n - 1)) mu / B^(n + 1)) is at most two smaller than the
+ * true quotient, so a - q m needs at most two more subtractions of m. That is one product of n + 1 blocks and one
+ * multiply-subtract instead of a division. Longer numbers are reduced n blocks at a time from the top.
+ *
+ * Montgomery's method needs an odd m and works on numbers in the form a R mod m with R = B^n. The product of two
+ * such numbers is brought back into the form by REDC: n times a multiple of m is added which clears the lowest
+ * block, using m' = -1 / m mod B, and the blocks are shifted down by n. No quotient is estimated at all, so powmod()
+ * keeps its intermediate results in this form and converts only at the start and the end.
+ */
+#include "aint_mod.hpp"
+#include "aint_kernels.hpp"
+
+
+modulus::modulus(const aint& value) : m(value)
+{
+    aint_view blocks{m};
+
+    n = blocks.size();
+
+    if(!n)
+        return;
+
+    mu = (aint{1} << (2 * n * kernel::limb_bits)) / m;
+
+    odd = blocks.data()[0] & 1;
+
+    if(!odd)
+        return;
+
+    // Newton's iteration doubles the correct low bits of the inverse, m * m = 1 mod 8 for odd m gives the first 3
+    uint64_t inverse = blocks.data()[0];
+
+    for(size_t i1 = 0; i1 < 5; ++i1)
+        inverse *= 2 - blocks.data()[0] * inverse;
+
+    m_inverse = -inverse;
+
+    r_squared = reduce(aint{1} << (2 * n * kernel::limb_bits));
+}
+
+
+aint modulus::barrett(const aint& a) const
+{
+    if(a < m)
+        return a;
+
+    aint q = aint_view{a}.high(n - 1) * mu;
+
+    aint r{a};
+
+    // q m does not exceed a, so the subtraction does not saturate, and q is at most two smaller than the quotient
+    submul(r, aint_view{q}.high(n + 1), m);
+
+    for(size_t i1 = 0; i1 < 2 && r >= m; ++i1)
+        r -= m;
+
+    return r;
+}
+
+
+aint modulus::reduce(const aint& a) const
+{
+    // like operator% the number stays as it is for m = 0
+    if(!n)
+        return a;
+
+    aint_view blocks{a};
+
+    if(blocks.size() <= 2 * n)
+        return barrett(a);
+
+    // r < m and the next part of at most n blocks stay below B^(2n)
+    size_t position = blocks.size() - 2 * n;
+
+    aint r = barrett(blocks.high(position));
+
+    while(position)
+    {
+        size_t part = position < n ? position : n;
+
+        position -= part;
+
+        r <<= part * kernel::limb_bits;
+
+        r += blocks.low(position + part).high(position);
+
+        r = barrett(r);
+    }
+
+    return r;
+}
+
+
+// operands of m or more are reduced first, so the product stays below m^2 < B^(2n)
+// without a modulus (m = 0) the results are those of the plain operators like for reduce()
+aint modulus::mulmod(const aint& a, const aint& b) const
+{
+    if(!n)
+        return a * b;
+
+    if(a >= m || b >= m)
+        return mulmod(reduce(a), reduce(b));
+
+    return barrett(a * b);
+}
+
+
+aint modulus::addmod(const aint& a, const aint& b) const
+{
+    if(!n)
+        return a + b;
+
+    if(a >= m || b >= m)
+        return addmod(reduce(a), reduce(b));
+
+    aint r = a + b;
+
+    if(r >= m)
+        r -= m;
+
+    return r;
+}
+
+
+aint modulus::submod(const aint& a, const aint& b) const
+{
+    if(!n)
+        return a - b;
+
+    if(a >= m || b >= m)
+        return submod(reduce(a), reduce(b));
+
+    if(a >= b)
+        return a - b;
+
+    aint r = a + m;
+
+    r -= b;
+
+    return r;
+}
+
+
+aint modulus::redc(const aint& a) const
+{
+    aint_view blocks{a};
+
+    aint_view modulus_blocks{m};
+
+    // n steps each clear one more block and may carry one block beyond the 2 n blocks of a
+    kernel::scratch temp{2 * n + 1};
+
+    kernel::limb* t = temp.get();
+
+    for(size_t i1 = 0; i1 <= 2 * n; ++i1)
+        t[i1] = i1 < blocks.size() ? blocks.data()[i1] : 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        kernel::limb carry = kernel::addmul_1(t + i1, modulus_blocks.data(), n, t[i1] * m_inverse);
+
+        kernel::add_1(t + i1 + n, t + i1 + n, n + 1 - i1, carry);
+    }
+
+    // the result is below 2 m
+    aint r{aint_view{t + n, n + 1}};
+
+    if(r >= m)
+        r -= m;
+
+    return r;
+}
+
+
+aint modulus::to_montgomery(const aint& a) const
+{
+    return redc(reduce(a) * r_squared);
+}
+
+
+// redc() needs a number below m R, which operands below m and their products are
+aint modulus::from_montgomery(const aint& a) const
+{
+    if(a >= m)
+        return redc(reduce(a));
+
+    return redc(a);
+}
+
+
+aint modulus::montgomery_mul(const aint& a, const aint& b) const
+{
+    if(a >= m || b >= m)
+        return montgomery_mul(reduce(a), reduce(b));
+
+    return redc(a * b);
+}
+
+
+// binary exponentiation from the most significant bit of the exponent
+aint modulus::powmod(const aint& base, const aint& exponent) const
+{
+    if(!n)
+        return aint{};
+
+    aint_view bits{exponent};
+
+    if(!odd)
+    {
+        aint x = reduce(base);
+
+        aint r = reduce(aint{1});
+
+        for(size_t i1 = bits.bit_length(); i1 > 0; --i1)
+        {
+            r = mulmod(r, r);
+
+            if(bits.data()[(i1 - 1) / kernel::limb_bits] >> ((i1 - 1) % kernel::limb_bits) & 1)
+                r = mulmod(r, x);
+        }
+
+        return r;
+    }
+
+    aint x = to_montgomery(base);
+
+    // 1 in Montgomery form is R mod m
+    aint r = reduce(aint{1} << (n * kernel::limb_bits));
+
+    for(size_t i1 = bits.bit_length(); i1 > 0; --i1)
+    {
+        r = montgomery_mul(r, r);
+
+        if(bits.data()[(i1 - 1) / kernel::limb_bits] >> ((i1 - 1) % kernel::limb_bits) & 1)
+            r = montgomery_mul(r, x);
+    }
+
+    return from_montgomery(r);
+}
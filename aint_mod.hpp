@@ -0,0 +1,79 @@
+#ifndef AINT_AINT_MOD_H
+#define AINT_AINT_MOD_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include "aint.hpp"
+
+// arithmetic modulo a fixed number m > 0 with constants computed once (see aint_mod.cpp)
+//
+// usage:
+//     modulus m{p};
+//     aint r = m.reduce(x);
+//     aint y = m.mulmod(a, b);
+//
+// all functions accept any number, operands below m like the results of reduce() save the reduction of the operands
+class modulus
+{
+public:
+
+    explicit modulus(const aint&);
+
+    const aint& value() const
+    {
+        return m;
+    }
+
+    // a mod m by Barrett's method, numbers of more than twice the blocks of m are reduced part by part
+    aint reduce(const aint& a) const;
+
+    aint mulmod(const aint& a, const aint& b) const;
+
+    aint addmod(const aint& a, const aint& b) const;
+
+    aint submod(const aint& a, const aint& b) const;
+
+    // base^exponent mod m, in Montgomery form for odd m
+    aint powmod(const aint& base, const aint& exponent) const;
+
+    // Montgomery form a R mod m with R = 2^(64 n) for m of n blocks, only for odd m
+    // products of numbers in this form stay in it and are reduced without a division
+    bool montgomery() const
+    {
+        return odd;
+    }
+
+    aint to_montgomery(const aint& a) const;
+
+    // a / R mod m, the number is brought back from the Montgomery form
+    aint from_montgomery(const aint& a) const;
+
+    // a b / R mod m, for a and b in Montgomery form this is their product in the form
+    aint montgomery_mul(const aint& a, const aint& b) const;
+
+private:
+
+    // a mod m for a of at most 2 n blocks
+    aint barrett(const aint& a) const;
+
+    // a / R mod m for a < m R (Montgomery's REDC)
+    aint redc(const aint& a) const;
+
+    aint m;
+
+    // number of blocks of m
+    size_t n = 0;
+
+    // Barrett reciprocal floor(2^(128 n) / m)
+    aint mu;
+
+    bool odd = false;
+
+    // -1 / m mod 2^64 and R^2 mod m for the Montgomery form
+    uint64_t m_inverse = 0;
+
+    aint r_squared;
+};
+
+#endif //AINT_AINT_MOD_H
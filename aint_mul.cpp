@@ -0,0 +1,723 @@
+/* Multiplication
+ *
+ * kernel::mul() chooses the algorithm by the length of the shorter operand:
+ *
+ * - the schoolbook method (mul_basecase) for short operands
+ * - Karatsuba which replaces one of four half sized products by additions
+ * - Toom-Cook 3-way which computes a product of thirds from five products evaluated at the points 0, 1, -1, 2 and
+ *   infinity, using the interpolation sequence of Bodrato
+ * - a number theoretic transform (NTT) for very large operands: the limbs are taken as coefficients of polynomials
+ *   whose cyclic convolution is computed modulo three primes just below 2^62 and recombined by the Chinese remainder
+ *   theorem. Every coefficient of the convolution is below 2^174 for transforms up to 2^46 points while the product of
+ *   the primes exceeds 2^185, so the result is exact. Reductions use Montgomery's method, there is no floating point.
+ *
+ * Both divide and conquer methods need operands of roughly the same length. If the longer operand is at least twice
+ * as long as the shorter one, it is cut into pieces of the length of the shorter operand whose products are added up.
+ *
+ * Squares have their own variants of the schoolbook method, Karatsuba and Toom-Cook (kernel::sqr) which compute every
+ * cross product only once. The NTT of a square needs one forward transform less.
+ *
+ * The crossover points are tunable through kernel::thresholds.
+ * Temporary results are kept in kernel::scratch arrays taken from the allocator of the calling thread.
+ */
+#include "aint_kernels.hpp"
+
+using kernel::limb;
+using kernel::double_limb;
+
+
+// adds c to r at the given offset, the sum must fit into rn limbs
+static void add_at(limb* r, size_t rn, size_t offset, const limb* c, size_t cn)
+{
+    cn = kernel::normalized_size(c, cn);
+
+    if(cn)
+        kernel::add(r + offset, r + offset, rn - offset, c, cn);
+}
+
+
+// r = |x - y| with xn >= yn, r has xn limbs, returns true if x < y
+static bool abs_sub(limb* r, const limb* x, size_t xn, const limb* y, size_t yn)
+{
+    size_t x_size = kernel::normalized_size(x, xn);
+
+    if(kernel::cmp(x, x_size, y, kernel::normalized_size(y, yn)) >= 0)
+    {
+        kernel::sub(r, x, xn, y, yn);
+
+        return false;
+    }
+
+    // x < y means that x has no more significant limbs than y
+    kernel::sub(r, y, yn, x, yn);
+
+    for(size_t i1 = yn; i1 < xn; ++i1)
+        r[i1] = 0;
+
+    return true;
+}
+
+
+// the longer operand is cut into pieces of the length of the shorter one
+static void mul_unbalanced(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    kernel::mul(r, a, bn, b, bn);
+
+    kernel::scratch product{2 * bn};
+
+    // r holds the product of the processed part of a which always reaches up to offset + bn
+    for(size_t offset = bn; offset < an; offset += bn)
+    {
+        size_t length = an - offset < bn ? an - offset : bn;
+
+        if(length == bn)
+            kernel::mul(product.get(), a + offset, length, b, bn);
+
+        else
+            kernel::mul(product.get(), b, bn, a + offset, length);
+
+        limb carry = kernel::add_n(r + offset, r + offset, product.get(), bn);
+
+        for(size_t i1 = 0; i1 < length; ++i1)
+            r[offset + bn + i1] = product.get()[bn + i1];
+
+        kernel::add_1(r + offset + bn, r + offset + bn, length, carry);
+    }
+}
+
+
+// Karatsuba with an >= bn > (an + 1) / 2
+// a = a1 * B^h + a0 and b = b1 * B^h + b0 with the limb base B, then
+// a * b = a1 b1 B^2h + (a0 b0 + a1 b1 - (a0 - a1)(b0 - b1)) B^h + a0 b0
+static void mul_karatsuba(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    size_t h = (an + 1) / 2;
+
+    size_t a_high = an - h;
+
+    size_t b_high = bn - h;
+
+    kernel::scratch temp{6 * h + 1};
+
+    limb* a_diff = temp.get();
+
+    limb* b_diff = a_diff + h;
+
+    limb* diff_product = b_diff + h;
+
+    limb* middle = diff_product + 2 * h;
+
+    bool a_negative = abs_sub(a_diff, a, h, a + h, a_high);
+
+    bool b_negative = abs_sub(b_diff, b, h, b + h, b_high);
+
+    // the outer products go straight to their place in r
+    kernel::mul(r, a, h, b, h);
+
+    kernel::mul(r + 2 * h, a + h, a_high, b + h, b_high);
+
+    kernel::mul(diff_product, a_diff, h, b_diff, h);
+
+    middle[2 * h] = kernel::add(middle, r, 2 * h, r + 2 * h, a_high + b_high);
+
+    // (a0 - a1)(b0 - b1) is positive if both differences have the same sign
+    if(a_negative == b_negative)
+        kernel::sub(middle, middle, 2 * h + 1, diff_product, 2 * h);
+
+    else
+        kernel::add(middle, middle, 2 * h + 1, diff_product, 2 * h);
+
+    add_at(r, an + bn, h, middle, 2 * h + 1);
+}
+
+
+// evaluates the polynomial x0 + x1 t + x2 t^2 with k limb coefficients (x2 has size limbs) at t = 1, -1 and 2
+// every result has k + 1 limbs, returns true if the value at -1 is negative and stores its absolute value
+static bool toom3_evaluate(limb* at_one, limb* at_minus_one, limb* at_two, const limb* x, size_t k, size_t size)
+{
+    const limb* x0 = x;
+
+    const limb* x1 = x + k;
+
+    const limb* x2 = x + 2 * k;
+
+    // x0 + x2
+    at_one[k] = kernel::add(at_one, x0, k, x2, size);
+
+    // |x0 + x2 - x1|
+    bool negative = abs_sub(at_minus_one, at_one, k + 1, x1, k);
+
+    // x0 + x2 + x1
+    at_one[k] += kernel::add_n(at_one, at_one, x1, k);
+
+    // ((2 x2 + x1) * 2) + x0
+    for(size_t i1 = 0; i1 <= k; ++i1)
+        at_two[i1] = i1 < size ? x2[i1] : 0;
+
+    kernel::lshift_n(at_two, at_two, k + 1, 1);
+
+    kernel::add(at_two, at_two, k + 1, x1, k);
+
+    kernel::lshift_n(at_two, at_two, k + 1, 1);
+
+    kernel::add(at_two, at_two, k + 1, x0, k);
+
+    return negative;
+}
+
+
+// interpolation of a Toom-Cook 3-way product of rn limbs, the values at 0 and infinity (top limbs) are already in place
+// at r and r + 4k, the values at 1, -1 and 2 have 2k + 2 limbs each and are overwritten
+// every coefficient of a product of non-negative polynomials is non-negative so apart from the value at -1
+// all intermediate results are non-negative as well
+static void toom3_interpolate(limb* r, size_t rn, size_t k, limb* v_one, limb* v_minus_one, limb* v_two,
+                              bool minus_one_negative, size_t top)
+{
+    size_t length = 2 * k + 2;
+
+    limb* v_zero = r;
+
+    limb* v_infinity = r + 4 * k;
+
+    // r3 = (v(2) - v(-1)) / 3
+    if(minus_one_negative)
+        kernel::add_n(v_two, v_two, v_minus_one, length);
+
+    else
+        kernel::sub_n(v_two, v_two, v_minus_one, length);
+
+    kernel::divexact_by3(v_two, v_two, length);
+
+    // r1 = (v(1) - v(-1)) / 2
+    if(minus_one_negative)
+        kernel::add_n(v_minus_one, v_one, v_minus_one, length);
+
+    else
+        kernel::sub_n(v_minus_one, v_one, v_minus_one, length);
+
+    kernel::rshift_n(v_minus_one, v_minus_one, length, 1);
+
+    // r2 = v(1) - v(0)
+    kernel::sub(v_one, v_one, length, v_zero, 2 * k);
+
+    // r3 = (r3 - r2) / 2 - 2 v(inf)
+    kernel::sub_n(v_two, v_two, v_one, length);
+
+    kernel::rshift_n(v_two, v_two, length, 1);
+
+    kernel::sub(v_two, v_two, length, v_infinity, top);
+
+    kernel::sub(v_two, v_two, length, v_infinity, top);
+
+    // r2 = r2 - r1 - v(inf)
+    kernel::sub_n(v_one, v_one, v_minus_one, length);
+
+    kernel::sub(v_one, v_one, length, v_infinity, top);
+
+    // r1 = r1 - r3
+    kernel::sub_n(v_minus_one, v_minus_one, v_two, length);
+
+    // recomposition of r0 + r1 B^k + r2 B^2k + r3 B^3k + r4 B^4k where r0 and r4 are already in place
+    for(size_t i1 = 2 * k; i1 < 4 * k; ++i1)
+        r[i1] = 0;
+
+    add_at(r, rn, k, v_minus_one, length);
+
+    add_at(r, rn, 2 * k, v_one, length);
+
+    add_at(r, rn, 3 * k, v_two, length);
+}
+
+
+// Toom-Cook 3-way with an >= bn > 2 * ceil(an / 3)
+static void mul_toom3(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    size_t k = (an + 2) / 3;
+
+    size_t a_top = an - 2 * k;
+
+    size_t b_top = bn - 2 * k;
+
+    // all products of evaluated values and all interpolated coefficients have this length
+    size_t length = 2 * k + 2;
+
+    kernel::scratch temp{6 * (k + 1) + 3 * length};
+
+    limb* a_one = temp.get();
+
+    limb* a_minus_one = a_one + (k + 1);
+
+    limb* a_two = a_minus_one + (k + 1);
+
+    limb* b_one = a_two + (k + 1);
+
+    limb* b_minus_one = b_one + (k + 1);
+
+    limb* b_two = b_minus_one + (k + 1);
+
+    limb* v_one = b_two + (k + 1);
+
+    limb* v_minus_one = v_one + length;
+
+    limb* v_two = v_minus_one + length;
+
+    bool minus_one_negative = toom3_evaluate(a_one, a_minus_one, a_two, a, k, a_top)
+                              != toom3_evaluate(b_one, b_minus_one, b_two, b, k, b_top);
+
+    // the products at 0 and infinity go straight to their place in r
+    limb* v_zero = r;
+
+    limb* v_infinity = r + 4 * k;
+
+    kernel::mul(v_zero, a, k, b, k);
+
+    kernel::mul(v_infinity, a + 2 * k, a_top, b + 2 * k, b_top);
+
+    kernel::mul(v_one, a_one, k + 1, b_one, k + 1);
+
+    kernel::mul(v_minus_one, a_minus_one, k + 1, b_minus_one, k + 1);
+
+    kernel::mul(v_two, a_two, k + 1, b_two, k + 1);
+
+    toom3_interpolate(r, an + bn, k, v_one, v_minus_one, v_two, minus_one_negative, a_top + b_top);
+}
+
+
+// arithmetic modulo a prime p < 2^62, products use Montgomery's method with R = 2^64
+// mul(a, b) = a * b / R mod p, so a factor in Montgomery form x * R mod p multiplies by x
+struct ntt_prime
+{
+    limb p;
+
+    // primitive root modulo p
+    limb generator;
+
+    // -p^-1 mod R
+    limb neg_inverse;
+
+    // R mod p, which is 1 in Montgomery form
+    limb one;
+
+    // R^2 mod p
+    limb r_squared;
+
+    constexpr ntt_prime(limb prime, limb root) : p(prime), generator(root), neg_inverse(0), one(0), r_squared(0)
+    {
+        // every Newton step doubles the number of correct bits, p is its own inverse modulo 8
+        limb inverse = p;
+
+        for(size_t i1 = 0; i1 < 5; ++i1)
+            inverse *= 2 - p * inverse;
+
+        neg_inverse = 0 - inverse;
+
+        one = (0 - p) % p;
+
+        r_squared = static_cast<limb>(static_cast<double_limb>(one) * one % p);
+    }
+
+    // a may be any limb, b < p, the result is < p
+    limb mul(limb a, limb b) const
+    {
+        double_limb product = static_cast<double_limb>(a) * b;
+
+        // intended cropping when converting to limb
+        limb m = static_cast<limb>(product) * neg_inverse;
+
+        // product + m * p < 2^65 * p is a multiple of R
+        limb reduced = static_cast<limb>((product + static_cast<double_limb>(m) * p) >> kernel::limb_bits);
+
+        return reduced >= p ? reduced - p : reduced;
+    }
+
+    limb add(limb a, limb b) const
+    {
+        limb sum = a + b;
+
+        return sum >= p ? sum - p : sum;
+    }
+
+    limb sub(limb a, limb b) const
+    {
+        return a >= b ? a - b : a + p - b;
+    }
+
+    // a mod p for any limb a
+    limb reduce(limb a) const
+    {
+        return mul(a, one);
+    }
+
+    limb to_montgomery(limb a) const
+    {
+        return mul(a, r_squared);
+    }
+
+    // base and result in Montgomery form
+    limb power(limb base, limb exponent) const
+    {
+        limb result = one;
+
+        for(; exponent; exponent >>= 1)
+        {
+            if(exponent & 1)
+                result = mul(result, base);
+
+            base = mul(base, base);
+        }
+
+        return result;
+    }
+};
+
+
+// p = c * 2^46 + 1 so there are roots of unity of every power of two order up to 2^46
+static constexpr ntt_prime ntt_primes[3] = {{0x3FFFC00000000001ull, 11},
+                                            {0x3FFAC00000000001ull, 3},
+                                            {0x3FEBC00000000001ull, 3}};
+
+
+// roots[i1] = w^i1 for i1 < length / 2 with w a root of unity of order length if inverse is false
+// or the inverse of such a root, all in Montgomery form
+static void ntt_roots(limb* roots, size_t length, const ntt_prime& prime, bool inverse)
+{
+    limb w = prime.power(prime.to_montgomery(prime.generator), (prime.p - 1) / length);
+
+    if(inverse)
+        w = prime.power(w, length - 1);
+
+    roots[0] = prime.one;
+
+    for(size_t i1 = 1; i1 < length / 2; ++i1)
+        roots[i1] = prime.mul(roots[i1 - 1], w);
+}
+
+
+// transform by decimation in frequency, takes x in natural order and leaves the result in bit reversed order
+// the values stay in normal form since every multiplication is by a root in Montgomery form
+static void ntt_forward(limb* x, size_t length, const limb* roots, const ntt_prime& prime)
+{
+    // a block of 2 * half values needs a root of order 2 * half which is w^stride
+    for(size_t half = length / 2, stride = 1; half > 0; half /= 2, stride *= 2)
+    {
+        for(size_t start = 0; start < length; start += 2 * half)
+        {
+            limb* low = x + start;
+
+            limb* high = low + half;
+
+            for(size_t i1 = 0; i1 < half; ++i1)
+            {
+                limb u = low[i1];
+
+                limb v = high[i1];
+
+                low[i1] = prime.add(u, v);
+
+                high[i1] = prime.mul(prime.sub(u, v), roots[i1 * stride]);
+            }
+        }
+    }
+}
+
+
+// inverse of ntt_forward up to the factor length, by decimation in time from bit reversed to natural order
+static void ntt_inverse(limb* x, size_t length, const limb* roots, const ntt_prime& prime)
+{
+    for(size_t half = 1, stride = length / 2; half < length; half *= 2, stride /= 2)
+    {
+        for(size_t start = 0; start < length; start += 2 * half)
+        {
+            limb* low = x + start;
+
+            limb* high = low + half;
+
+            for(size_t i1 = 0; i1 < half; ++i1)
+            {
+                limb u = low[i1];
+
+                limb v = prime.mul(high[i1], roots[i1 * stride]);
+
+                low[i1] = prime.add(u, v);
+
+                high[i1] = prime.sub(u, v);
+            }
+        }
+    }
+}
+
+
+// x = a * b modulo the prime as cyclic convolution of length points, y is a temporary of the same length
+// a square needs only one forward transform
+static void ntt_convolution(limb* x, limb* y, limb* roots, size_t length, const limb* a, size_t an,
+                            const limb* b, size_t bn, const ntt_prime& prime)
+{
+    bool square = (a == b && an == bn);
+
+    if(square)
+        y = x;
+
+    for(size_t i1 = 0; i1 < length; ++i1)
+        x[i1] = i1 < an ? prime.reduce(a[i1]) : 0;
+
+    ntt_roots(roots, length, prime, false);
+
+    ntt_forward(x, length, roots, prime);
+
+    if(!square)
+    {
+        for(size_t i1 = 0; i1 < length; ++i1)
+            y[i1] = i1 < bn ? prime.reduce(b[i1]) : 0;
+
+        ntt_forward(y, length, roots, prime);
+    }
+
+    // the pointwise products carry a factor 1 / R which is cancelled together with the factor length
+    // of the inverse transform by a single multiplication with R^2 / length
+    limb scale = prime.mul(prime.power(prime.to_montgomery(length), prime.p - 2), prime.r_squared);
+
+    for(size_t i1 = 0; i1 < length; ++i1)
+        x[i1] = prime.mul(prime.mul(x[i1], y[i1]), scale);
+
+    ntt_roots(roots, length, prime, true);
+
+    ntt_inverse(x, length, roots, prime);
+}
+
+
+// three prime NTT, the operands may have any length, a and b may be the same array of an = bn limbs for a square
+static void mul_ntt(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    // the product has an + bn - 1 coefficients which must not wrap around
+    size_t length = 2;
+
+    while(length < an + bn - 1)
+        length *= 2;
+
+    kernel::scratch temp{5 * length};
+
+    limb* residues = temp.get();
+
+    limb* y = residues + 3 * length;
+
+    limb* roots = y + length;
+
+    for(size_t i1 = 0; i1 < 3; ++i1)
+        ntt_convolution(residues + i1 * length, y, roots, length, a, an, b, bn, ntt_primes[i1]);
+
+    // Garner's algorithm: the coefficient is v1 + v2 p1 + v3 p1 p2 with v1 < p1, v2 < p2 and v3 < p3
+    const ntt_prime& prime_1 = ntt_primes[0];
+
+    const ntt_prime& prime_2 = ntt_primes[1];
+
+    const ntt_prime& prime_3 = ntt_primes[2];
+
+    // p1^-1 mod p2, p1 mod p3 and (p1 p2)^-1 mod p3 in Montgomery form
+    limb inverse_12 = prime_2.power(prime_2.to_montgomery(prime_1.p), prime_2.p - 2);
+
+    limb p1_mod_3 = prime_3.to_montgomery(prime_1.p);
+
+    limb inverse_123 = prime_3.power(prime_3.mul(p1_mod_3, prime_3.to_montgomery(prime_2.p)), prime_3.p - 2);
+
+    double_limb p1_p2 = static_cast<double_limb>(prime_1.p) * prime_2.p;
+
+    limb p1_p2_low = static_cast<limb>(p1_p2);
+
+    limb p1_p2_high = static_cast<limb>(p1_p2 >> kernel::limb_bits);
+
+    // the coefficients overlap by two limbs, the carry into the next position needs two limbs as well
+    limb carry_low = 0;
+
+    limb carry_high = 0;
+
+    for(size_t i1 = 0; i1 + 1 < an + bn; ++i1)
+    {
+        limb v1 = residues[i1];
+
+        limb v2 = prime_2.mul(prime_2.sub(residues[length + i1], prime_2.reduce(v1)), inverse_12);
+
+        limb partial = prime_3.add(prime_3.reduce(v1), prime_3.mul(v2, p1_mod_3));
+
+        limb v3 = prime_3.mul(prime_3.sub(residues[2 * length + i1], partial), inverse_123);
+
+        double_limb low = static_cast<double_limb>(v2) * prime_1.p + v1;
+
+        double_limb middle = static_cast<double_limb>(v3) * p1_p2_low;
+
+        double_limb high = static_cast<double_limb>(v3) * p1_p2_high;
+
+        double_limb sum = static_cast<double_limb>(carry_low) + static_cast<limb>(low) + static_cast<limb>(middle);
+
+        // intended cropping when converting to limb
+        r[i1] = static_cast<limb>(sum);
+
+        sum >>= kernel::limb_bits;
+
+        sum += static_cast<double_limb>(carry_high) + static_cast<limb>(low >> kernel::limb_bits)
+               + static_cast<limb>(middle >> kernel::limb_bits) + static_cast<limb>(high);
+
+        carry_low = static_cast<limb>(sum);
+
+        carry_high = static_cast<limb>((sum >> kernel::limb_bits) + (high >> kernel::limb_bits));
+    }
+
+    // the product fits into an + bn limbs so carry_high is 0 here
+    r[an + bn - 1] = carry_low;
+}
+
+
+// Karatsuba for squares: a^2 = a1^2 B^2h + (a0^2 + a1^2 - (a0 - a1)^2) B^h + a0^2
+// the square of the difference does not depend on its sign
+static void sqr_karatsuba(limb* r, const limb* a, size_t n)
+{
+    size_t h = (n + 1) / 2;
+
+    size_t high = n - h;
+
+    kernel::scratch temp{5 * h + 1};
+
+    limb* diff = temp.get();
+
+    limb* diff_square = diff + h;
+
+    limb* middle = diff_square + 2 * h;
+
+    abs_sub(diff, a, h, a + h, high);
+
+    kernel::sqr(r, a, h);
+
+    kernel::sqr(r + 2 * h, a + h, high);
+
+    kernel::sqr(diff_square, diff, h);
+
+    middle[2 * h] = kernel::add(middle, r, 2 * h, r + 2 * h, 2 * high);
+
+    kernel::sub(middle, middle, 2 * h + 1, diff_square, 2 * h);
+
+    add_at(r, 2 * n, h, middle, 2 * h + 1);
+}
+
+
+// Toom-Cook 3-way for squares, every product of evaluated values is a square and the value at -1 is positive
+static void sqr_toom3(limb* r, const limb* a, size_t n)
+{
+    size_t k = (n + 2) / 3;
+
+    size_t top = n - 2 * k;
+
+    size_t length = 2 * k + 2;
+
+    kernel::scratch temp{3 * (k + 1) + 3 * length};
+
+    limb* a_one = temp.get();
+
+    limb* a_minus_one = a_one + (k + 1);
+
+    limb* a_two = a_minus_one + (k + 1);
+
+    limb* v_one = a_two + (k + 1);
+
+    limb* v_minus_one = v_one + length;
+
+    limb* v_two = v_minus_one + length;
+
+    toom3_evaluate(a_one, a_minus_one, a_two, a, k, top);
+
+    kernel::sqr(r, a, k);
+
+    kernel::sqr(r + 4 * k, a + 2 * k, top);
+
+    kernel::sqr(v_one, a_one, k + 1);
+
+    kernel::sqr(v_minus_one, a_minus_one, k + 1);
+
+    kernel::sqr(v_two, a_two, k + 1);
+
+    toom3_interpolate(r, 2 * n, k, v_one, v_minus_one, v_two, false, 2 * top);
+}
+
+
+void kernel::mul(limb* r, const limb* a, size_t an, const limb* b, size_t bn)
+{
+    // Karatsuba needs at least two limbs to split, below that the threshold is not honoured
+    if(bn < 2 || bn < thresholds.mul_karatsuba)
+        mul_basecase(r, a, an, b, bn);
+
+    // Karatsuba needs a non-empty upper half of b
+    else if(2 * bn <= an + 1)
+        mul_unbalanced(r, a, an, b, bn);
+
+    else if(bn >= thresholds.mul_ntt)
+        mul_ntt(r, a, an, b, bn);
+
+    // Toom-Cook needs a non-empty upper third of b
+    else if(bn >= thresholds.mul_toom3 && bn > 2 * ((an + 2) / 3))
+        mul_toom3(r, a, an, b, bn);
+
+    else
+        mul_karatsuba(r, a, an, b, bn);
+}
+
+
+void kernel::sqr_basecase(limb* r, const limb* a, size_t n)
+{
+    if(n == 1)
+    {
+        double_limb square = static_cast<double_limb>(a[0]) * a[0];
+
+        r[0] = static_cast<limb>(square);
+
+        r[1] = static_cast<limb>(square >> limb_bits);
+
+        return;
+    }
+
+    // the products a[i1] * a[i2] with i1 < i2 occupy r[1] to r[2n - 2], each of them is computed only once
+    r[0] = 0;
+
+    r[n] = mul_1(r + 1, a + 1, n - 1, a[0]);
+
+    for(size_t i1 = 1; i1 + 1 < n; ++i1)
+        r[n + i1] = addmul_1(r + 2 * i1 + 1, a + i1 + 1, n - i1 - 1, a[i1]);
+
+    // doubled they appear twice in the square
+    r[2 * n - 1] = lshift_n(r + 1, r + 1, 2 * n - 2, 1);
+
+    // and finally the squares a[i1]^2 at position 2 i1
+    double_limb carry = 0;
+
+    for(size_t i1 = 0; i1 < n; ++i1)
+    {
+        double_limb square = static_cast<double_limb>(a[i1]) * a[i1];
+
+        carry += static_cast<double_limb>(r[2 * i1]) + static_cast<limb>(square);
+
+        // intended cropping when converting to limb
+        r[2 * i1] = static_cast<limb>(carry);
+
+        carry >>= limb_bits;
+
+        carry += static_cast<double_limb>(r[2 * i1 + 1]) + static_cast<limb>(square >> limb_bits);
+
+        r[2 * i1 + 1] = static_cast<limb>(carry);
+
+        carry >>= limb_bits;
+    }
+}
+
+
+void kernel::sqr(limb* r, const limb* a, size_t n)
+{
+    if(n < 2 || n < thresholds.sqr_karatsuba)
+        sqr_basecase(r, a, n);
+
+    else if(n >= thresholds.mul_ntt)
+        mul_ntt(r, a, n, a, n);
+
+    // Toom-Cook needs a non-empty upper third
+    else if(n >= thresholds.sqr_toom3 && n > 2 * ((n + 2) / 3))
+        sqr_toom3(r, a, n);
+
+    else
+        sqr_karatsuba(r, a, n);
+}
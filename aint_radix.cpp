@@ -0,0 +1,378 @@
+/* Decimal and hexadecimal text
+ *
+ * Hexadecimal digits map to the blocks directly: 16 digits are one block, so the text is converted block by block
+ * with tables for the characters of a byte and for the value of a character.
+ *
+ * Decimal text is converted by divide and conquer with the powers 10^(19 * 2^k), each of which is the square of the
+ * previous one (10^19 is the largest power of ten in a block). A number below 10^(19 * 2^(k + 1)) is divided by
+ * 10^(19 * 2^k) into an upper and a lower half of the digits which are converted independently, and reading joins
+ * the halves with one multiplication. With the fast multiplication and division this takes O(M(n) log n) instead of
+ * the quadratic time of converting 19 digits at a time. The powers are shared by all parts and kept per thread for
+ * the following conversions, each one only squares the powers that are still missing for its number. The cache grows
+ * to about the size of the largest number converted on the thread. Numbers in an allocator installed by an
+ * allocator_scope must not outlive the scope, so conversions within one compute their powers for the call alone.
+ * Below kernel::thresholds.radix_dc blocks the parts are converted 19 digits at a time, by dividing by 10^19 with a
+ * precomputed reciprocal or by multiplying with 10^19.
+ */
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "aint.hpp"
+#include "aint_alloc.hpp"
+#include "aint_kernels.hpp"
+
+
+class radix_conversion
+{
+public:
+
+    static std::string to_hex(const aint&);
+
+    static aint from_hex(const char*, size_t);
+
+    static std::string to_decimal(const aint&);
+
+    static aint from_decimal(const char*, size_t);
+
+    // the binary format of operator>>, least significant bit first
+    static aint from_binary(const char*, size_t);
+
+private:
+
+    // 10^19
+    static constexpr uint64_t group_value = 10000000000000000000ull;
+
+    static constexpr size_t group_digits = 19;
+
+    // powers[k] = 10^(19 * 2^k) of the calling thread or local if they cannot be kept
+    static std::vector<aint>& decimal_powers(std::vector<aint>& local);
+
+    static void write_decimal_basecase(char*, size_t, const aint&);
+
+    static void write_decimal(char*, size_t, const aint&, const std::vector<aint>&, size_t);
+
+    static aint read_decimal_basecase(const char*, size_t);
+
+    static aint read_decimal(const char*, size_t, const std::vector<aint>&);
+};
+
+
+// the two hexadecimal characters of every byte
+static const auto hex_chars = []()
+{
+    std::array<std::array<char, 2>, 256> table{};
+
+    const char* digits = "0123456789abcdef";
+
+    for(size_t i1 = 0; i1 < 256; ++i1)
+    {
+        table[i1][0] = digits[i1 >> 4];
+
+        table[i1][1] = digits[i1 & 0xF];
+    }
+
+    return table;
+}();
+
+
+// the value of every character as a digit, 0xFF for characters which are not a hexadecimal digit
+static const auto digit_values = []()
+{
+    std::array<uint8_t, 256> table{};
+
+    for(size_t i1 = 0; i1 < 256; ++i1)
+        table[i1] = 0xFF;
+
+    for(uint8_t i1 = 0; i1 < 10; ++i1)
+        table['0' + i1] = i1;
+
+    for(uint8_t i1 = 0; i1 < 6; ++i1)
+    {
+        table['a' + i1] = static_cast<uint8_t>(10 + i1);
+
+        table['A' + i1] = static_cast<uint8_t>(10 + i1);
+    }
+
+    return table;
+}();
+
+
+static uint8_t digit_value(char c)
+{
+    return digit_values[static_cast<unsigned char>(c)];
+}
+
+
+std::string radix_conversion::to_hex(const aint& num)
+{
+    if(!num.number_blocks)
+        return "0";
+
+    aint::block_type top = num.storage[num.number_blocks - 1];
+
+    // the most significant block is written without leading zeros
+    size_t top_digits = (num.bits_used + 3) / 4;
+
+    std::string text(top_digits + (num.number_blocks - 1) * 16, '0');
+
+    char* position = &text[0];
+
+    for(size_t i1 = top_digits; i1 > 0; --i1)
+        *position++ = hex_chars[(top >> (4 * (i1 - 1))) & 0xF][1];
+
+    for(size_t i1 = num.number_blocks - 1; i1 > 0; --i1)
+    {
+        aint::block_type block = num.storage[i1 - 1];
+
+        for(size_t i2 = 8; i2 > 0; --i2)
+        {
+            std::memcpy(position, hex_chars[(block >> (8 * (i2 - 1))) & 0xFF].data(), 2);
+
+            position += 2;
+        }
+    }
+
+    return text;
+}
+
+
+aint radix_conversion::from_hex(const char* text, size_t length)
+{
+    aint result{};
+
+    result.reserve((length + 15) / 16);
+
+    // every 16 digits from the end are one block
+    for(size_t end = length; end > 0; end = end > 16 ? end - 16 : 0)
+    {
+        size_t begin = end > 16 ? end - 16 : 0;
+
+        aint::block_type block = 0;
+
+        for(size_t i1 = begin; i1 < end; ++i1)
+            block = (block << 4) | digit_value(text[i1]);
+
+        result.storage[result.number_blocks++] = block;
+    }
+
+    result.normalize();
+
+    return result;
+}
+
+
+std::vector<aint>& radix_conversion::decimal_powers(std::vector<aint>& local)
+{
+    static thread_local std::vector<aint> cached;
+
+    std::vector<aint>& powers = block_allocator::installed() ? local : cached;
+
+    if(powers.empty())
+        powers.push_back(aint{group_value});
+
+    return powers;
+}
+
+
+// writes exactly digits characters, padded with leading zeros, the number has to fit into them
+void radix_conversion::write_decimal_basecase(char* text, size_t digits, const aint& num)
+{
+    static const kernel::limb_divisor group{group_value};
+
+    kernel::scratch temp{num.number_blocks ? num.number_blocks : 1};
+
+    aint::block_type* quotient = temp.get();
+
+    for(size_t i1 = 0; i1 < num.number_blocks; ++i1)
+        quotient[i1] = num.storage[i1];
+
+    size_t length = num.number_blocks;
+
+    char* position = text + digits;
+
+    // groups of 19 digits from the least significant end
+    while(length)
+    {
+        aint::block_type remainder = kernel::divrem_1_preinv(quotient, quotient, length, group);
+
+        length = kernel::normalized_size(quotient, length);
+
+        for(size_t i1 = 0; i1 < group_digits && position > text; ++i1)
+        {
+            *--position = static_cast<char>('0' + remainder % 10);
+
+            remainder /= 10;
+        }
+    }
+
+    while(position > text)
+        *--position = '0';
+}
+
+
+// writes exactly digits = 19 * 2^(level + 1) characters of a number below powers[level + 1], padded with zeros
+void radix_conversion::write_decimal(char* text, size_t digits, const aint& num, const std::vector<aint>& powers,
+                                     size_t level)
+{
+    if(!level || num.number_blocks < kernel::thresholds.radix_dc)
+    {
+        write_decimal_basecase(text, digits, num);
+
+        return;
+    }
+
+    aint high{};
+
+    aint low{};
+
+    divmod(num, powers[level], high, low);
+
+    write_decimal(text, digits / 2, high, powers, level - 1);
+
+    write_decimal(text + digits / 2, digits / 2, low, powers, level - 1);
+}
+
+
+std::string radix_conversion::to_decimal(const aint& num)
+{
+    std::vector<aint> local;
+
+    std::vector<aint>& powers = decimal_powers(local);
+
+    // the first power above the number
+    size_t level = 0;
+
+    for(; powers[level] <= num; ++level)
+        if(level + 1 == powers.size())
+            powers.push_back(square(powers.back()));
+
+    std::string text(group_digits << level, '0');
+
+    if(level)
+        write_decimal(&text[0], text.size(), num, powers, level - 1);
+
+    else
+        write_decimal_basecase(&text[0], text.size(), num);
+
+    size_t zeros = text.find_first_not_of('0');
+
+    return zeros == std::string::npos ? "0" : text.substr(zeros);
+}
+
+
+aint radix_conversion::read_decimal_basecase(const char* text, size_t length)
+{
+    aint result{};
+
+    // the first group takes the digits that are not a multiple of 19
+    size_t group = length % group_digits ? length % group_digits : group_digits;
+
+    for(size_t begin = 0; begin < length; begin += group, group = group_digits)
+    {
+        uint64_t value = 0;
+
+        for(size_t i1 = begin; i1 < begin + group; ++i1)
+            value = value * 10 + digit_value(text[i1]);
+
+        result *= group_value;
+
+        result += value;
+    }
+
+    return result;
+}
+
+
+aint radix_conversion::read_decimal(const char* text, size_t length, const std::vector<aint>& powers)
+{
+    // a block holds about 19.3 decimal digits, a single group cannot be split any further
+    if(length <= group_digits || length < kernel::thresholds.radix_dc * group_digits)
+        return read_decimal_basecase(text, length);
+
+    // the lower digits take the largest power with less digits than the text
+    size_t level = 0;
+
+    while((group_digits << (level + 1)) < length)
+        ++level;
+
+    size_t low_digits = group_digits << level;
+
+    aint result = read_decimal(text, length - low_digits, powers) * powers[level];
+
+    result += read_decimal(text + length - low_digits, low_digits, powers);
+
+    return result;
+}
+
+
+aint radix_conversion::from_decimal(const char* text, size_t length)
+{
+    std::vector<aint> local;
+
+    std::vector<aint>& powers = decimal_powers(local);
+
+    while((group_digits << powers.size()) < length)
+        powers.push_back(square(powers.back()));
+
+    return read_decimal(text, length, powers);
+}
+
+
+aint radix_conversion::from_binary(const char* text, size_t length)
+{
+    aint result{};
+
+    result.reserve((length + aint::block_bits - 1) / aint::block_bits);
+
+    for(size_t begin = 0; begin < length; begin += aint::block_bits)
+    {
+        aint::block_type block = 0;
+
+        for(size_t i1 = begin; i1 < length && i1 < begin + aint::block_bits; ++i1)
+            block |= static_cast<aint::block_type>(text[i1] == '1') << (i1 - begin);
+
+        result.storage[result.number_blocks++] = block;
+    }
+
+    result.normalize();
+
+    return result;
+}
+
+
+std::string to_string(const aint& num, unsigned base)
+{
+    if(base == 10)
+        return radix_conversion::to_decimal(num);
+
+    if(base == 16)
+        return radix_conversion::to_hex(num);
+
+    std::string text(num.bit_length() ? num.bit_length() : 1, '0');
+
+    to_chars(&text[0], &text[0] + text.size(), num);
+
+    return text;
+}
+
+
+aint from_string(std::string_view text, unsigned base)
+{
+    // only the leading digits of the base count
+    size_t length = 0;
+
+    if(base == 10 || base == 16)
+    {
+        while(length < text.size() && digit_value(text[length]) < base)
+            ++length;
+
+        return base == 10 ? radix_conversion::from_decimal(text.data(), length)
+                          : radix_conversion::from_hex(text.data(), length);
+    }
+
+    while(length < text.size() && (text[length] == '0' || text[length] == '1'))
+        ++length;
+
+    return radix_conversion::from_binary(text.data(), length);
+}
@@ -0,0 +1,224 @@
+/* Multi input gcd
+ *
+ * The input is read in chunks of chunk_size numbers. Every chunk is reduced to its gcd by a pool of worker threads
+ * while the next chunk is read, and the gcds of the chunks are combined as they finish. Only a few chunks per worker
+ * are in flight at a time, so the memory does not depend on the length of the input. Once the gcd is 1 the rest of
+ * the input cannot change it anymore and is not read.
+ *
+ * A finished chunk combines its gcd with the gcd of the chunks before without holding the lock, which would otherwise
+ * make all other workers and the reader wait for a long computation. It takes a copy of the value, computes the gcd
+ * and stores it only if no other chunk stored one in the meantime, else it starts over with the newer value.
+ *
+ * Each worker of the pool has its own queue. New tasks are spread over the queues, a worker takes the newest task of
+ * its own queue and, if that is empty, steals the oldest task of another worker.
+ */
+#include <utility>
+#include "aint_stream.hpp"
+
+
+work_stealing_pool::work_stealing_pool(size_t threads)
+{
+    if(!threads)
+        threads = 1;
+
+    for(size_t i1 = 0; i1 < threads; ++i1)
+        queues.emplace_back(new task_queue{});
+
+    for(size_t i1 = 0; i1 < threads; ++i1)
+        workers.emplace_back(&work_stealing_pool::run, this, i1);
+}
+
+
+work_stealing_pool::~work_stealing_pool()
+{
+    {
+        std::lock_guard<std::mutex> guard(idle_lock);
+
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for(auto& worker : workers)
+        worker.join();
+}
+
+
+void work_stealing_pool::submit(std::function<void()> task)
+{
+    task_queue& queue = *queues[next];
+
+    next = (next + 1) % queues.size();
+
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        queue.tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(idle_lock);
+
+        ++queued;
+    }
+
+    wake.notify_one();
+}
+
+
+bool work_stealing_pool::take(size_t index, std::function<void()>& task)
+{
+    for(size_t i1 = 0; i1 < queues.size(); ++i1)
+    {
+        task_queue& queue = *queues[(index + i1) % queues.size()];
+
+        std::lock_guard<std::mutex> guard(queue.lock);
+
+        if(queue.tasks.empty())
+            continue;
+
+        // the own queue is used from the back, others are robbed from the front
+        if(!i1)
+        {
+            task = std::move(queue.tasks.back());
+
+            queue.tasks.pop_back();
+        }
+
+        else
+        {
+            task = std::move(queue.tasks.front());
+
+            queue.tasks.pop_front();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void work_stealing_pool::run(size_t index)
+{
+    for(;;)
+    {
+        // a task is claimed while it is counted, so the queues hold one for every claim and take() cannot miss
+        {
+            std::unique_lock<std::mutex> guard(idle_lock);
+
+            wake.wait(guard, [this]() { return queued || stopping; });
+
+            if(!queued)
+                return;
+
+            --queued;
+        }
+
+        std::function<void()> task;
+
+        // never fails because of the claim, but an empty task must not be called if it ever did
+        if(take(index, task))
+            task();
+    }
+}
+
+
+// combines the gcd of a chunk with the gcd of the finished chunks
+static void combine(partial_gcd& result, aint value)
+{
+    std::unique_lock<std::mutex> guard(result.lock);
+
+    for(;;)
+    {
+        aint previous{result.value};
+
+        size_t updates = result.updates;
+
+        guard.unlock();
+
+        value = gcd(previous, value);
+
+        guard.lock();
+
+        // a newer value divides the previous one, so the gcd computed so far is combined with it instead of the chunk
+        if(result.updates == updates)
+            break;
+    }
+
+    result.value.swap(value);
+
+    ++result.updates;
+
+    --result.in_flight;
+
+    result.finished.notify_all();
+}
+
+
+stream_status reduce_stream(std::istream& in, work_stealing_pool& pool, partial_gcd& result, size_t& count)
+{
+    std::vector<aint> chunk;
+
+    chunk.reserve(chunk_size);
+
+    aint number;
+
+    for(;;)
+    {
+        bool reading = static_cast<bool>(in >> number);
+
+        // operator>> only reaches the end of the stream after skipping trailing whitespace
+        if(!reading && !in.eof())
+            return stream_status::malformed;
+
+        if(reading)
+        {
+            chunk.push_back(std::move(number));
+
+            ++count;
+        }
+
+        // a chunk is handed to the pool when it is full or the stream ends
+        if(chunk.size() < chunk_size && (reading || chunk.empty()))
+        {
+            if(!reading)
+                return stream_status::complete;
+
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> guard(result.lock);
+
+            result.finished.wait(guard, [&]() { return result.in_flight < chunks_per_worker * pool.size(); });
+
+            if(result.value == 1)
+                return stream_status::gcd_one;
+
+            ++result.in_flight;
+        }
+
+        pool.submit([numbers = std::move(chunk), &result]()
+        {
+            aint value{};
+
+            for(const auto& number : numbers)
+            {
+                value = gcd(value, number);
+
+                if(value == 1)
+                    break;
+            }
+
+            combine(result, std::move(value));
+        });
+
+        if(!reading)
+            return stream_status::complete;
+
+        chunk = std::vector<aint>{};
+
+        chunk.reserve(chunk_size);
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef AINT_AINT_STREAM_H
+#define AINT_AINT_STREAM_H
+
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "aint.hpp"
+
+// gcd of all numbers of one or more streams, computed by a pool of worker threads (see aint_stream.cpp)
+//
+// usage:
+//     partial_gcd result;
+//     {
+//         work_stealing_pool pool{std::thread::hardware_concurrency()};
+//         size_t count = 0;
+//         reduce_stream(std::cin, pool, result, count);
+//     }
+//     // result.value is complete once the pool has finished its tasks
+class work_stealing_pool
+{
+public:
+
+    explicit work_stealing_pool(size_t);
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    // finishes all submitted tasks before the workers are stopped
+    ~work_stealing_pool();
+
+    void submit(std::function<void()>);
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+private:
+
+    struct task_queue
+    {
+        std::mutex lock;
+
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // takes a task from the own queue or steals one from another worker
+    bool take(size_t, std::function<void()>&);
+
+    void run(size_t);
+
+    std::vector<std::unique_ptr<task_queue>> queues;
+
+    std::vector<std::thread> workers;
+
+    // queue for the next submitted task
+    size_t next = 0;
+
+    // number of queued tasks, idle workers sleep until it becomes positive
+    std::mutex idle_lock;
+
+    std::condition_variable wake;
+
+    size_t queued = 0;
+
+    bool stopping = false;
+};
+
+
+// gcd of all chunks finished so far
+struct partial_gcd
+{
+    std::mutex lock;
+
+    std::condition_variable finished;
+
+    aint value{};
+
+    // counts the changes of value, a worker which computed with an older value has to combine again
+    size_t updates = 0;
+
+    size_t in_flight = 0;
+};
+
+
+constexpr size_t chunk_size = 1024;
+
+// chunks in flight per worker
+constexpr size_t chunks_per_worker = 2;
+
+
+enum class stream_status
+{
+    complete,
+
+    // the gcd is 1 and no further input is needed
+    gcd_one,
+
+    // a token is not a binary number
+    malformed
+};
+
+
+// reads the numbers of a stream into chunks for the pool and adds their count to count
+stream_status reduce_stream(std::istream&, work_stealing_pool&, partial_gcd&, size_t& count);
+
+#endif //AINT_AINT_STREAM_H
@@ -0,0 +1,1250 @@
+/* Tests
+ *
+ * Every result is compared with a reference: a value worked out by hand for the edge cases of the kernels, the same
+ * operation computed with thresholds so high that only the schoolbook methods run, an identity like q b + r = a, or
+ * a known constant. For the fast algorithms the thresholds are forced down to the smallest sizes the algorithms
+ * accept, so they all run on operands of a few dozen blocks.
+ *
+ * Returns 0 if all checks pass and prints the failed ones otherwise.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <random>
+#include <system_error>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+#include "aint.hpp"
+#include "aint_alloc.hpp"
+#include "aint_expr.hpp"
+#include "aint_file.hpp"
+#include "aint_kernels.hpp"
+#include "aint_mod.hpp"
+#include "aint_stream.hpp"
+
+
+static size_t failures = 0;
+
+static void check(bool passed, const char* what)
+{
+    if(passed)
+        return;
+
+    ++failures;
+
+    std::cerr << "failed: " << what << std::endl;
+}
+
+
+static std::mt19937_64 generator{20191123};
+
+static constexpr uint64_t ones = ~uint64_t{0};
+
+// random number of exactly the given number of blocks
+static aint random_number(size_t blocks)
+{
+    aint result{};
+
+    for(size_t i1 = 0; i1 < blocks; ++i1)
+    {
+        result <<= 64;
+
+        result += generator() | (i1 ? 0 : uint64_t{1} << 63);
+    }
+
+    return result;
+}
+
+
+static size_t random_size(size_t max)
+{
+    return 1 + generator() % max;
+}
+
+
+// only the schoolbook methods
+static kernel::tuning basecase()
+{
+    constexpr size_t never = std::numeric_limits<size_t>::max();
+
+    kernel::tuning t{};
+
+    t.mul_karatsuba = t.mul_toom3 = t.mul_ntt = t.sqr_karatsuba = t.sqr_toom3 = never;
+
+    t.div_dc = t.hgcd = t.gcd_dc = t.radix_dc = never;
+
+    return t;
+}
+
+
+// every algorithm from the smallest size on, the NTT takes over all products if ntt is set
+static kernel::tuning forced(bool ntt)
+{
+    kernel::tuning t = basecase();
+
+    t.mul_karatsuba = t.sqr_karatsuba = 2;
+
+    t.mul_toom3 = t.sqr_toom3 = 3;
+
+    if(ntt)
+        t.mul_ntt = 2;
+
+    t.div_dc = 4;
+
+    t.hgcd = 2;
+
+    t.gcd_dc = 2;
+
+    t.radix_dc = 1;
+
+    return t;
+}
+
+
+static const kernel::tuning forced_configurations[] = {forced(false), forced(true)};
+
+
+static void test_kernels()
+{
+    using limbs = std::vector<kernel::limb>;
+
+    // the carry runs through all limbs and leaves the array
+    limbs a{ones, ones, ones};
+
+    limbs r(3);
+
+    check(kernel::add_n(r.data(), a.data(), limbs{1, 0, 0}.data(), 3) == 1 && r == limbs{0, 0, 0}, "add_n carry out");
+
+    check(kernel::add_n(a.data(), a.data(), limbs{0, 1, 0}.data(), 3) == 1 && a == limbs{ones, 0, 0},
+          "add_n in place");
+
+    // the borrow runs up to the first non-zero limb or leaves the array
+    check(kernel::sub_n(r.data(), limbs{0, 0, 5}.data(), limbs{1, 0, 0}.data(), 3) == 0 && r == limbs{ones, ones, 4},
+          "sub_n borrow through");
+
+    check(kernel::sub_n(r.data(), limbs{0, 0, 0}.data(), limbs{0, 1, 0}.data(), 3) == 1
+          && r == limbs{0, ones, ones}, "sub_n borrow out");
+
+    // shifts by 0 are copies, by 63 every limb moves all but one bit to its neighbour
+    a = limbs{1, 3, uint64_t{1} << 63};
+
+    check(kernel::lshift_n(r.data(), a.data(), 3, 0) == 0 && r == a, "lshift_n by 0");
+
+    check(kernel::lshift_n(r.data(), a.data(), 3, 63) == uint64_t{1} << 62
+          && r == (limbs{uint64_t{1} << 63, uint64_t{1} << 63, 1}), "lshift_n by 63");
+
+    check(kernel::rshift_n(r.data(), a.data(), 3, 0) == 0 && r == a, "rshift_n by 0");
+
+    check(kernel::rshift_n(r.data(), a.data(), 3, 63) == 2 && r == (limbs{6, 0, 1}),
+          "rshift_n by 63");
+
+    // the shifts may move limbs within the same array
+    limbs overlap{1, 2, 3, 0};
+
+    kernel::lshift_n(overlap.data() + 1, overlap.data(), 3, 0);
+
+    check(overlap == (limbs{1, 1, 2, 3}), "lshift_n moving up");
+
+    kernel::rshift_n(overlap.data(), overlap.data() + 1, 3, 0);
+
+    check(overlap == (limbs{1, 2, 3, 3}), "rshift_n moving down");
+
+    // 0 - 5 leaves 2^64 - 5 and a borrow of 1, the largest product leaves the largest borrow
+    r = limbs{0};
+
+    check(kernel::submul_1(r.data(), limbs{1}.data(), 1, 5) == 1 && r[0] == ones - 4, "submul_1 borrow out");
+
+    r = limbs{0, 0};
+
+    check(kernel::submul_1(r.data(), limbs{ones, ones}.data(), 2, ones) == ones && r == (limbs{ones, 0}),
+          "submul_1 large borrow");
+
+    // the reciprocal has to give exactly the quotients of the division instruction
+    const kernel::limb divisors[] = {1, 2, 3, 10, uint64_t{1} << 63, (uint64_t{1} << 63) + 1, ones, ones - 1};
+
+    for(size_t i1 = 0; i1 < 200; ++i1)
+    {
+        kernel::limb d = i1 < sizeof(divisors) / sizeof(divisors[0]) ? divisors[i1] : generator() >> (i1 % 64);
+
+        if(!d)
+            d = 1;
+
+        limbs n(1 + i1 % 9);
+
+        for(auto& limb : n)
+            limb = i1 % 3 ? generator() : ones;
+
+        limbs q(n.size());
+
+        limbs q_preinv(n.size());
+
+        kernel::limb remainder = kernel::divrem_1(q.data(), n.data(), n.size(), d);
+
+        check(kernel::divrem_1_preinv(q_preinv.data(), n.data(), n.size(), kernel::limb_divisor{d}) == remainder
+              && q_preinv == q, "divrem_1_preinv");
+
+        check(kernel::mod_1(n.data(), n.size(), d) == remainder, "mod_1");
+    }
+}
+
+
+// hands out storage from the heap and counts what is taken and given back
+class counting_allocator final : public block_allocator
+{
+public:
+
+    uint64_t* allocate(size_t& blocks) override
+    {
+        ++allocations;
+
+        return static_cast<uint64_t*>(::operator new(blocks * sizeof(uint64_t)));
+    }
+
+    void deallocate(uint64_t* ptr, size_t) override
+    {
+        ++deallocations;
+
+        ::operator delete(ptr);
+    }
+
+    size_t allocations = 0;
+
+    size_t deallocations = 0;
+};
+
+
+static void test_allocators()
+{
+    // the most recent allocation of an arena is rolled back and handed out again, older ones stay until the end
+    {
+        block_arena arena{64};
+
+        size_t blocks = 10;
+
+        uint64_t* first = arena.allocate(blocks);
+
+        arena.deallocate(first, blocks);
+
+        check(arena.allocate(blocks) == first, "arena reuses the most recent allocation");
+
+        uint64_t* second = arena.allocate(blocks);
+
+        arena.deallocate(first, blocks);
+
+        check(arena.allocate(blocks) == second + blocks, "arena keeps older allocations");
+
+        // a request larger than the rest of the chunk comes from a new chunk
+        size_t large = 100;
+
+        uint64_t* outside = arena.allocate(large);
+
+        check(outside + large <= first || outside >= first + 64, "arena starts a new chunk");
+    }
+
+    // every scope restores the allocator which was installed before it
+    {
+        counting_allocator outer, inner;
+
+        check(block_allocator::installed() == nullptr, "no allocator installed");
+
+        {
+            allocator_scope outer_scope{outer};
+
+            {
+                allocator_scope inner_scope{inner};
+
+                check(block_allocator::installed() == &inner, "inner scope installed");
+            }
+
+            check(block_allocator::installed() == &outer, "outer scope restored");
+        }
+
+        check(block_allocator::installed() == nullptr, "thread pool restored");
+    }
+
+    // a number returns its storage to the allocator it came from, wherever it is moved or destroyed
+    {
+        counting_allocator counting;
+
+        aint outside = aint{1} << 10000;
+
+        aint moved;
+
+        {
+            allocator_scope scope{counting};
+
+            aint inside = aint{1} << 10000;
+
+            moved = std::move(inside);
+
+            // storage of the pool released in the scope goes back to the pool
+            outside = aint{};
+        }
+
+        check(counting.allocations == 1 && counting.deallocations == 0, "storage taken in a scope");
+
+        aint target{std::move(moved)};
+
+        target <<= 100000;
+
+        check(counting.allocations == 1 && counting.deallocations == 1, "storage given back outside the scope");
+
+        {
+            allocator_scope scope{counting};
+
+            target = aint{};
+        }
+
+        check(counting.deallocations == 1, "pool storage not given to the scope's allocator");
+    }
+
+    // each size class keeps at most 4 MB, here 512 arrays of 1024 blocks, released ones come back last in first out
+    {
+        block_pool pool;
+
+        std::vector<uint64_t*> released(600);
+
+        for(auto& ptr : released)
+            ptr = static_cast<uint64_t*>(::operator new(1024 * sizeof(uint64_t)));
+
+        for(auto ptr : released)
+            pool.deallocate(ptr, 1024);
+
+        bool in_order = true;
+
+        std::vector<uint64_t*> taken(512);
+
+        for(size_t i1 = 0; i1 < taken.size(); ++i1)
+        {
+            size_t blocks = 1000;
+
+            taken[i1] = pool.allocate(blocks);
+
+            in_order = in_order && blocks == 1024 && taken[i1] == released[511 - i1];
+        }
+
+        check(in_order, "pool caps a size class");
+
+        for(auto ptr : taken)
+            ::operator delete(ptr);
+    }
+}
+
+
+// the compound operators work in the storage of the left operand and have to agree with the binary operators
+static void test_compound_operators()
+{
+    for(size_t i1 = 0; i1 < 100; ++i1)
+    {
+        aint a = random_number(random_size(40));
+
+        aint b = random_number(random_size(40));
+
+        aint c{a};
+
+        c += b;
+
+        check(c == a + b, "operator+=");
+
+        c -= b;
+
+        check(c == a, "operator-=");
+
+        c -= a + b;
+
+        check(c == 0, "operator-= saturates at 0");
+
+        c = a;
+
+        c *= b;
+
+        check(c == a * b, "operator*=");
+
+        c /= b;
+
+        check(c == a, "operator/=");
+
+        c = a;
+
+        c %= b;
+
+        check(c == a % b && c < b, "operator%=");
+
+        c = a;
+
+        c <<= i1;
+
+        c >>= i1 + 1;
+
+        check(c == a >> 1, "shift operators");
+
+        // the right operand may be the object itself
+        c = a;
+
+        c *= c;
+
+        check(c == a * a, "operator*= with itself");
+
+        c %= c;
+
+        check(c == 0, "operator%= with itself");
+
+        c = a;
+
+        c += c;
+
+        check(c == a << 1, "operator+= with itself");
+    }
+}
+
+
+static void test_multiplication()
+{
+    for(size_t i1 = 0; i1 < 100; ++i1)
+    {
+        aint a = random_number(random_size(80));
+
+        aint b = random_number(random_size(80));
+
+        kernel::thresholds = basecase();
+
+        aint product = a * b;
+
+        aint a_square = square(a);
+
+        // a copy of a is multiplied like any other factor
+        check(a_square == a * aint{a}, "schoolbook square");
+
+        for(const auto& configuration : forced_configurations)
+        {
+            kernel::thresholds = configuration;
+
+            check(a * b == product, "product");
+
+            check(square(a) == a_square && a * a == a_square, "square");
+
+            aint c{a};
+
+            c *= b;
+
+            check(c == product, "operator*=");
+        }
+    }
+}
+
+
+static void test_division()
+{
+    for(size_t i1 = 0; i1 < 100; ++i1)
+    {
+        aint a = random_number(random_size(160));
+
+        // divisors with the top bit of their top block cleared need a normalization shift
+        aint b = random_number(random_size(80)) >> (i1 % 64);
+
+        kernel::thresholds = basecase();
+
+        aint q = a / b, r = a % b;
+
+        check(q * b + r == a && r < b, "schoolbook division");
+
+        // the largest remainder makes the quotient estimates as large as possible
+        check((q * b + b - 1) / b == q && (q * b + b - 1) % b == b - 1, "largest remainder");
+
+        check(divmod(a, b) == std::make_pair(q, r), "divmod");
+
+        // the outputs may be the operands themselves
+        aint quotient{a}, remainder{b};
+
+        divmod(quotient, remainder, quotient, remainder);
+
+        check(quotient == q && remainder == r, "divmod into the operands");
+
+        for(const auto& configuration : forced_configurations)
+        {
+            kernel::thresholds = configuration;
+
+            check(divmod(a, b) == std::make_pair(q, r), "recursive division");
+
+            aint c{a};
+
+            c %= b;
+
+            check(c == r, "recursive operator%=");
+        }
+    }
+
+    aint a = random_number(5);
+
+    check(divmod(a, aint{}) == std::make_pair(aint{}, a), "divmod by 0");
+
+    auto by_word = divmod(a, uint64_t{1000});
+
+    check(by_word.first == a / 1000 && by_word.second == a % 1000, "divmod by a word");
+}
+
+
+// division by a single word against the division by a number of one block
+static void test_word_division()
+{
+    kernel::thresholds = basecase();
+
+    const uint64_t divisors[] = {1, 3, 10, uint64_t{1} << 63, ones};
+
+    for(size_t i1 = 0; i1 < 40; ++i1)
+    {
+        uint64_t d = i1 < sizeof(divisors) / sizeof(divisors[0]) ? divisors[i1] : generator() >> (i1 % 64) | 1;
+
+        aint a = random_number(random_size(30));
+
+        aint q = a / aint{d}, r = a % aint{d};
+
+        check(a / d == q && a % d == r, "operators with a word divisor");
+
+        aint c{a};
+
+        c /= d;
+
+        check(c == q, "operator/= with a word");
+
+        c = a;
+
+        c %= d;
+
+        check(c == r, "operator%= with a word");
+
+        kernel::limb_divisor divisor{d};
+
+        aint quotient{};
+
+        check(divmod(a, divisor, quotient) == r && quotient == q, "division by a limb_divisor");
+    }
+}
+
+
+// the operators with a single word against the same operators with a number of one block
+static void test_word_operators()
+{
+    for(size_t i1 = 0; i1 < 40; ++i1)
+    {
+        aint a = i1 % 4 ? random_number(random_size(10)) : (aint{1} << (64 * random_size(10))) - 1;
+
+        uint64_t w = i1 % 3 ? generator() : ones;
+
+        aint b{w};
+
+        check(a + w == a + b && w + a == a + b && a - w == a - b && a * w == a * b && w * a == a * b,
+              "arithmetic with a word");
+
+        check((a == w) == (a == b) && (w == a) == (a == b) && (a != w) == (a != b) && (w != a) == (a != b),
+              "equality with a word");
+
+        check((a < w) == (a < b) && (w < a) == (b < a) && (a <= w) == (a <= b) && (w <= a) == (b <= a)
+              && (a > w) == (a > b) && (w > a) == (b > a) && (a >= w) == (a >= b) && (w >= a) == (b >= a),
+              "order with a word");
+
+        aint c{a};
+
+        c += w;
+
+        check(c == a + b, "operator+= with a word");
+
+        c -= w;
+
+        check(c == a, "operator-= with a word");
+
+        c *= w;
+
+        check(c == a * b, "operator*= with a word");
+    }
+
+    // a single block and 0
+    check(aint{5} - uint64_t{7} == 0 && aint{7} == uint64_t{7} && uint64_t{0} == aint{} && aint{} < uint64_t{1},
+          "small numbers with a word");
+}
+
+
+static void test_gcd()
+{
+    for(size_t i1 = 0; i1 < 40; ++i1)
+    {
+        aint common = random_number(random_size(20));
+
+        aint a = random_number(random_size(60)) * common;
+
+        aint b = random_number(random_size(60)) * common;
+
+        kernel::thresholds = basecase();
+
+        aint reference = gcd(a, b);
+
+        check(a % reference == 0 && b % reference == 0 && reference % common == 0
+              && gcd(a / reference, b / reference) == 1, "Lehmer gcd");
+
+        check(gcd(b, a) == reference && gcd(a, aint{}) == a && gcd(a, a + 1) == 1, "gcd identities");
+
+        for(const auto& configuration : forced_configurations)
+        {
+            kernel::thresholds = configuration;
+
+            check(gcd(a, b) == reference, "half gcd");
+        }
+    }
+
+    check(gcd(aint{}, aint{}) == 0 && gcd(aint{12}, aint{18}) == 6, "small gcd");
+}
+
+
+static void test_xgcd()
+{
+    const kernel::tuning configurations[] = {basecase(), forced(false), forced(true)};
+
+    for(size_t i1 = 0; i1 < 30; ++i1)
+    {
+        aint common = random_number(random_size(10));
+
+        aint a = random_number(random_size(40)) * common;
+
+        aint b = random_number(random_size(40)) * common;
+
+        // odd moduli, a is not invertible if it shares a factor with m
+        aint m = random_number(random_size(30));
+
+        if(m % 2 == 0)
+            m += 1;
+
+        for(const auto& configuration : configurations)
+        {
+            kernel::thresholds = configuration;
+
+            aint s{}, t{};
+
+            aint g = xgcd(a, b, s, t);
+
+            check(g == gcd(a, b) && a * s - b * t == g && s > 0 && s <= b / g, "xgcd");
+
+            aint inverse = modinv(a, m);
+
+            check(gcd(a, m) == 1 ? inverse < m && a * inverse % m == 1 : inverse == 0, "modinv");
+        }
+    }
+
+    kernel::thresholds = basecase();
+
+    aint s{}, t{};
+
+    check(xgcd(aint{42}, aint{}, s, t) == 42 && s == 1 && t == 0, "xgcd with 0");
+
+    check(modinv(aint{3}, aint{}) == 0 && modinv(aint{4}, aint{6}) == 0 && modinv(aint{3}, aint{7}) == 5,
+          "small inverses");
+
+    aint m = random_number(8);
+
+    if(m % 2 == 0)
+        m += 1;
+
+    std::vector<aint> numbers;
+
+    for(size_t i1 = 0; i1 < 10; ++i1)
+        numbers.push_back(random_number(random_size(12)));
+
+    std::vector<aint> inverses = modinv(numbers, m);
+
+    for(size_t i1 = 0; i1 < numbers.size(); ++i1)
+        check(inverses[i1] == modinv(numbers[i1], m), "modinv of many numbers");
+}
+
+
+static void test_batch_gcd()
+{
+    kernel::thresholds = forced(false);
+
+    std::vector<aint> numbers;
+
+    for(size_t i1 = 0; i1 < 9; ++i1)
+        numbers.push_back(random_number(random_size(12)) * (i1 % 3 ? aint{7} : aint{3}));
+
+    std::vector<aint> gcds = batch_gcd(numbers);
+
+    check(gcds.size() == numbers.size(), "batch_gcd size");
+
+    for(size_t i1 = 0; i1 < numbers.size() && i1 < gcds.size(); ++i1)
+    {
+        aint others{1};
+
+        for(size_t i2 = 0; i2 < numbers.size(); ++i2)
+            if(i2 != i1)
+                others *= numbers[i2];
+
+        check(gcds[i1] == gcd(numbers[i1], others), "batch_gcd");
+    }
+
+    check(batch_gcd(std::vector<aint>{aint{6}}) == std::vector<aint>{aint{1}} && batch_gcd(std::vector<aint>{}).empty(),
+          "batch_gcd of one or no number");
+}
+
+
+// runs reduce_stream on the text and returns the status, the gcd and the number of numbers read
+static stream_status reduce_text(const std::string& text, size_t threads, aint& value, size_t& count)
+{
+    std::istringstream in{text};
+
+    partial_gcd result;
+
+    count = 0;
+
+    stream_status status;
+
+    {
+        work_stealing_pool pool{threads};
+
+        status = reduce_stream(in, pool, result, count);
+    }
+
+    value = result.value;
+
+    return status;
+}
+
+
+static void test_stream_gcd()
+{
+    kernel::thresholds = basecase();
+
+    aint value{};
+
+    size_t count = 0;
+
+    check(reduce_text("", 2, value, count) == stream_status::complete && count == 0 && value == 0, "empty stream");
+
+    check(reduce_text(" \n\t", 2, value, count) == stream_status::complete && count == 0, "only whitespace");
+
+    // the 1 before x is read as a number, the x stops the stream
+    check(reduce_text("101 11 1x1", 2, value, count) == stream_status::malformed && count == 3, "malformed number");
+
+    check(reduce_text("101 2", 2, value, count) == stream_status::malformed, "digit outside of binary");
+
+    // more chunks than may be in flight with one worker, so the reader has to wait for finished chunks
+    aint common = random_number(3);
+
+    std::ostringstream text;
+
+    size_t numbers = (chunks_per_worker + 3) * chunk_size + 17;
+
+    aint reference{};
+
+    for(size_t i1 = 0; i1 < numbers; ++i1)
+    {
+        aint number = common * random_number(random_size(2));
+
+        reference = gcd(reference, number);
+
+        text << number << (i1 % 7 ? ' ' : '\n');
+    }
+
+    check(reduce_text(text.str(), 1, value, count) == stream_status::complete && count == numbers
+          && value == reference, "chunks waiting for the pool");
+
+    check(reduce_text(text.str(), 4, value, count) == stream_status::complete && value == reference,
+          "chunks on several workers");
+
+    // with only ones every finished chunk makes the gcd 1, at the latest the third chunk has to wait for one
+    std::string ones_text;
+
+    for(size_t i1 = 0; i1 < 10 * chunk_size; ++i1)
+        ones_text += "1 ";
+
+    check(reduce_text(ones_text, 1, value, count) == stream_status::gcd_one && value == 1
+          && count <= (chunks_per_worker + 1) * chunk_size, "stop at gcd 1");
+}
+
+
+// hands out the text in pieces of the given length, or character by character without a buffer for length 0
+class piecewise_buffer final : public std::streambuf
+{
+public:
+
+    piecewise_buffer(std::string text, size_t length) : text(std::move(text)), length(length)
+    {
+    }
+
+protected:
+
+    int_type underflow() override
+    {
+        if(length && gptr())
+            position = static_cast<size_t>(gptr() - text.data());
+
+        if(position >= text.size())
+            return traits_type::eof();
+
+        if(length)
+        {
+            size_t piece = text.size() - position < length ? text.size() - position : length;
+
+            setg(&text[0], &text[position], &text[position + piece]);
+        }
+
+        return traits_type::to_int_type(text[position]);
+    }
+
+    int_type uflow() override
+    {
+        if(length)
+            return std::streambuf::uflow();
+
+        if(position >= text.size())
+            return traits_type::eof();
+
+        return traits_type::to_int_type(text[position++]);
+    }
+
+private:
+
+    std::string text;
+
+    size_t length;
+
+    // next character without a buffer, start of the next piece with one
+    size_t position = 0;
+};
+
+
+static void test_binary_input()
+{
+    aint x{};
+
+    // the loop ends after the last number and leaves the stream failed at its end
+    std::istringstream numbers{"101 11\n 0  "};
+
+    std::vector<aint> read;
+
+    while(numbers >> x)
+        read.push_back(x);
+
+    check(read == std::vector<aint>{aint{5}, aint{3}, aint{}} && numbers.fail() && numbers.eof(), "reading loop");
+
+    // a number at the very end sets eofbit but does not fail, the next read fails
+    std::istringstream trailing{"0011"};
+
+    trailing >> x;
+
+    check(x == 12 && trailing.eof() && !trailing.fail(), "number at the end");
+
+    trailing >> x;
+
+    check(x == 0 && trailing.eof() && trailing.fail(), "read after the end");
+
+    std::istringstream empty{""};
+
+    empty >> x;
+
+    check(x == 0 && empty.eof() && empty.fail(), "empty input");
+
+    // the first character which is not a binary digit ends the number and stays in the stream
+    std::istringstream other{"1012"};
+
+    other >> x;
+
+    check(x == 5 && !other.fail() && !other.eof() && other.peek() == '2', "other character");
+
+    std::istringstream only_other{"x1"};
+
+    only_other >> x;
+
+    check(x == 0 && only_other.fail() && !only_other.eof(), "no digit");
+
+    // long numbers ending within and at the end of the bulk parsed parts of the buffer
+    for(size_t i1 = 0; i1 < 20; ++i1)
+    {
+        aint a = random_number(random_size(12)) >> (i1 * 7);
+
+        std::ostringstream out;
+
+        out << a << ' ' << a;
+
+        const size_t lengths[] = {0, 1, 5, 31, 33, 4096};
+
+        for(size_t length : lengths)
+        {
+            piecewise_buffer buffer{out.str(), length};
+
+            std::istream in{&buffer};
+
+            aint first{}, second{};
+
+            in >> first >> second;
+
+            check(first == a && second == a && in.eof() && !in.fail(), "stream buffer with small pieces");
+        }
+    }
+}
+
+
+static void test_binary_output()
+{
+    for(size_t i1 = 0; i1 < 20; ++i1)
+    {
+        aint a = i1 ? random_number(random_size(12)) >> (i1 * 7) : aint{};
+
+        std::ostringstream out;
+
+        out << a;
+
+        std::string text = out.str();
+
+        check(text.size() == (a == 0 ? 1 : a.bit_length()) && text.back() == (a == 0 ? '0' : '1'),
+              "binary output");
+
+        // the characters fit exactly or the range is one too short
+        std::string chars(text.size(), 'x');
+
+        std::to_chars_result result = to_chars(&chars[0], &chars[0] + chars.size(), a);
+
+        check(result.ec == std::errc{} && result.ptr == &chars[0] + chars.size() && chars == text, "to_chars");
+
+        chars.assign(text.size() - 1, 'x');
+
+        result = to_chars(&chars[0], &chars[0] + chars.size(), a);
+
+        check(result.ec == std::errc::value_too_large && result.ptr == &chars[0] + chars.size()
+              && chars == std::string(text.size() - 1, 'x'), "to_chars one character short");
+    }
+
+    // even 0 needs one character
+    char zero = 'x';
+
+    check(to_chars(&zero, &zero, aint{}).ec == std::errc::value_too_large && zero == 'x', "to_chars into nothing");
+
+    check(to_chars(&zero, &zero + 1, aint{}).ptr == &zero + 1 && zero == '0', "to_chars of 0");
+}
+
+
+static void test_text()
+{
+    kernel::thresholds = basecase();
+
+    check(to_string(aint{1} << 100) == "1267650600228229401496703205376", "known decimal");
+
+    check(to_string(aint{1} << 100, 16) == "10000000000000000000000000", "known hexadecimal");
+
+    check(from_string("1267650600228229401496703205376") == (aint{1} << 100), "decimal input");
+
+    check(to_string(aint{}) == "0" && from_string("") == 0 && from_string("0042x7") == 42, "short decimals");
+
+    // 10^19 is the first number with a second group of digits
+    aint group{10000000000000000000ull};
+
+    check(to_string(group - 1) == std::string(19, '9') && to_string(group) == "1" + std::string(19, '0'),
+          "decimal group boundary");
+
+    for(size_t i1 = 0; i1 < 30; ++i1)
+    {
+        aint a = random_number(random_size(120));
+
+        kernel::thresholds = basecase();
+
+        std::string decimal = to_string(a);
+
+        for(const auto& configuration : forced_configurations)
+        {
+            kernel::thresholds = configuration;
+
+            check(to_string(a) == decimal, "decimal output");
+
+            check(from_string(decimal) == a, "decimal round trip");
+
+            check(from_string(to_string(a, 16), 16) == a, "hexadecimal round trip");
+        }
+    }
+
+    // the powers kept from the long numbers above serve short ones as well, in a scope they are computed anew
+    kernel::thresholds = forced(false);
+
+    aint a = random_number(7);
+
+    std::string decimal = to_string(a);
+
+    check(from_string(decimal) == a, "decimal with kept powers");
+
+    block_arena arena;
+
+    {
+        allocator_scope scope{arena};
+
+        check(to_string(a) == decimal && from_string(decimal) == a, "decimal within an allocator scope");
+
+        check(to_string(random_number(130)).size() > 2400, "long decimal within an allocator scope");
+    }
+
+    check(to_string(a) == decimal, "decimal after an allocator scope");
+}
+
+
+static void test_files()
+{
+    kernel::thresholds = basecase();
+
+    aint a = random_number(12);
+
+    std::vector<aint> numbers{a, aint{}, aint{42}, random_number(3)};
+
+    const char* path = "aint_test_numbers.bin";
+
+    {
+        aint_file_writer writer{path};
+
+        for(const auto& number : numbers)
+            writer.write(number);
+
+        check(writer.close(), "file writer");
+    }
+
+    {
+        mapped_aint_file file{path};
+
+        check(file.is_open() && file.size() == numbers.size(), "mapped file");
+
+        for(size_t i1 = 0; file.is_open() && i1 < numbers.size(); ++i1)
+            check(file[i1] == numbers[i1], "mapped number");
+
+        if(file.is_open())
+        {
+            check(file[0] * file[3] == a * numbers[3], "arithmetic on mapped numbers");
+
+            // a copy owns its blocks and stays valid after the file is closed
+            aint copy{file[0]};
+
+            copy += 1;
+
+            file.close();
+
+            check(!file.is_open() && copy == a + 1, "copy of a mapped number");
+        }
+    }
+
+    // a file cut short or overwritten with other data is rejected
+    std::ifstream in{path, std::ios::binary};
+
+    std::string bytes{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+
+    in.close();
+
+    std::ofstream{path, std::ios::binary | std::ios::trunc}.write(bytes.data(),
+                                                                 static_cast<std::streamsize>(bytes.size() - 8));
+
+    check(!mapped_aint_file{path}.is_open(), "truncated file");
+
+    std::ofstream{path, std::ios::binary | std::ios::trunc} << std::string(bytes.size(), 'x');
+
+    check(!mapped_aint_file{path}.is_open(), "file without a header");
+
+    std::remove(path);
+
+    check(!mapped_aint_file{path}.is_open(), "missing file");
+}
+
+
+static void test_views()
+{
+    kernel::thresholds = basecase();
+
+    aint a = random_number(12);
+
+    aint_view view{a};
+
+    check(view == a && view.size() == 12 && view.data() == aint_view{a}.data(), "view of a number");
+
+    check(view.low(5) == a % (aint{1} << 320), "low slice");
+
+    check(view.high(5) == (a >> 320) && view.top(3) == (a >> 576), "high slices");
+
+    check(view.high(20).zero() && view.low(20) == a && view.top(20) == a, "slices beyond the number");
+
+    // leading zero blocks of an array do not count
+    const uint64_t blocks[] = {7, 0, 1, 0, 0};
+
+    aint_view array{blocks, 5};
+
+    check(array.size() == 3 && array.bit_length() == 129 && array == (aint{1} << 128) + 7, "view of an array");
+
+    check(array.low(2) == 7 && aint_view{blocks, 0}.zero(), "view of a few blocks");
+
+    // views take part in every operation which does not modify them
+    aint b = random_number(4);
+
+    check(view.high(4) * b + view.low(4) == (a >> 256) * b + a % (aint{1} << 256), "arithmetic on views");
+
+    check(gcd(view, view.low(6)) == gcd(a, a % (aint{1} << 384)), "gcd of views");
+
+    aint r{a};
+
+    r -= view.high(2);
+
+    check(r == a - (a >> 128), "view as an operand of a compound operator");
+
+    aint_view copy{view};
+
+    copy = view.top(2);
+
+    check(copy == a >> 640 && view == a, "copied view");
+}
+
+
+static void test_expressions()
+{
+    using aint_expr::lazy;
+
+    kernel::thresholds = forced(false);
+
+    for(size_t i1 = 0; i1 < 40; ++i1)
+    {
+        aint a = random_number(random_size(30)), b = random_number(random_size(30));
+
+        aint c = random_number(random_size(40)), d = random_number(random_size(70));
+
+        aint r = random_number(random_size(10));
+
+        aint previous{r};
+
+        evaluate(r, lazy(r) * a + c - d);
+
+        check(r == previous * a + c - d, "Horner step");
+
+        previous = r;
+
+        evaluate(r, lazy(r) - a * b + (lazy(c) << 100) + 5u);
+
+        check(r == previous - a * b + (c << 100) + 5, "fused multiply and shift");
+
+        check(evaluate(lazy(a) * 3u - lazy(b) * b) == a * 3 - b * b, "scaled terms");
+
+        // the destination on both sides of a sum or inside a product
+        previous = r;
+
+        evaluate(r, lazy(r) * r + r);
+
+        check(r == previous * previous + previous, "destination in several terms");
+
+        previous = r;
+
+        evaluate(r, lazy(a) - (lazy(r) << 64) - uint8_t{1});
+
+        check(r == a - (previous << 64) - 1, "saturated difference");
+
+        check(evaluate(lazy(a) - (lazy(b) - c)) == a - (b - c), "difference of a difference");
+    }
+}
+
+
+static void test_modulus()
+{
+    kernel::thresholds = forced(false);
+
+    for(size_t i1 = 0; i1 < 40; ++i1)
+    {
+        size_t n = random_size(20);
+
+        aint m = random_number(n) + i1 % 2;
+
+        modulus context{m};
+
+        aint a = random_number(random_size(60)), b = random_number(random_size(30));
+
+        check(context.reduce(a) == a % m, "Barrett reduction");
+
+        check(context.mulmod(a, b) == a * b % m, "mulmod");
+
+        check(context.addmod(a, b) == (a + b) % m, "addmod");
+
+        check(context.submod(a, b) == (a % m + m - b % m) % m, "submod");
+
+        aint exponent{generator() % 200};
+
+        aint power{1};
+
+        for(uint64_t i2 = 0; exponent > i2; ++i2)
+            power = power * a % m;
+
+        check(context.powmod(a, exponent) == power, "powmod");
+
+        if(!context.montgomery())
+            continue;
+
+        check(context.from_montgomery(context.to_montgomery(a)) == a % m, "Montgomery form");
+
+        // operands of more than 2 n blocks, so a R m and the product a b exceed what REDC can take at once
+        aint x = random_number(3 * n + random_size(10)), y = random_number(2 * n + random_size(10));
+
+        aint r = (aint{1} << (64 * n)) % m;
+
+        check(context.from_montgomery(x) * r % m == x % m, "unreduced from_montgomery");
+
+        check(context.montgomery_mul(x, y) == context.from_montgomery(x * y)
+              && context.montgomery_mul(x, y) * r % m == x * y % m, "unreduced montgomery_mul");
+    }
+
+    // m = 1 leaves only 0
+    modulus one{aint{1}};
+
+    check(one.reduce(random_number(3)) == 0 && one.powmod(aint{5}, aint{3}) == 0 && one.mulmod(aint{2}, aint{3}) == 0,
+          "modulus 1");
+}
+
+
+int main()
+{
+    test_kernels();
+
+    test_allocators();
+
+    test_compound_operators();
+
+    test_multiplication();
+
+    test_division();
+
+    test_word_division();
+
+    test_word_operators();
+
+    test_gcd();
+
+    test_xgcd();
+
+    test_batch_gcd();
+
+    test_stream_gcd();
+
+    test_binary_input();
+
+    test_binary_output();
+
+    test_text();
+
+    test_files();
+
+    test_views();
+
+    test_expressions();
+
+    test_modulus();
+
+    if(failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+
+        return 1;
+    }
+
+    std::cout << "all checks passed" << std::endl;
+
+    return 0;
+}
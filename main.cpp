@@ -1,33 +1,68 @@
-#include <list>
+/* Multi input gcd
+ *
+ * Prints the gcd of all numbers read from the files given as arguments or, without arguments, from stdin. The numbers
+ * are binary with the least significant bit first (see aint.cpp) and separated by whitespace. They are reduced in
+ * chunks by a pool of worker threads while the input is read (see aint_stream.cpp).
+ */
+#include <fstream>
 #include <iostream>
-#include <utility>
+#include <thread>
 #include "aint.hpp"
+#include "aint_stream.hpp"
 
-aint gcd(aint a, aint b) {
-    if(a<b) a.swap(b);
-    for(;;) {
-        if(b.zero()) return a;
-        a%=b;
-        a.swap(b);
-    }
-}
 
-int main() {
-    std::list<aint> l;
-    aint tmp;
-    //while(std::cin >> tmp) l.emplace_back(std::move(tmp));
-    for(size_t i1 = 0; i1 < 2; ++i1)
+int main(int argc, char** argv)
+{
+    // without synchronisation with stdio std::cin gets a buffer which operator>> can parse in bulk
+    std::ios::sync_with_stdio(false);
+
+    partial_gcd result;
+
+    size_t count = 0;
+
     {
-        std::cin >> tmp;
-        l.emplace_back((std::move(tmp)));
+        work_stealing_pool pool{std::thread::hardware_concurrency()};
+
+        if(argc < 2 && reduce_stream(std::cin, pool, result, count) == stream_status::malformed)
+        {
+            std::cerr << "malformed input after " << count << " numbers" << std::endl;
+
+            return 1;
+        }
+
+        for(int i1 = 1; i1 < argc; ++i1)
+        {
+            std::ifstream file{argv[i1]};
+
+            if(!file)
+            {
+                std::cerr << "cannot open " << argv[i1] << std::endl;
+
+                return 1;
+            }
+
+            stream_status status = reduce_stream(file, pool, result, count);
+
+            if(status == stream_status::malformed)
+            {
+                std::cerr << "malformed input in " << argv[i1] << " after " << count << " numbers" << std::endl;
+
+                return 1;
+            }
+
+            if(status == stream_status::gcd_one)
+                break;
+        }
     }
-    if(l.empty()) return 1;
 
-    tmp=std::move(l.front());
-    l.pop_front();
-    for(auto&n:l) tmp = gcd(tmp, n);
+    if(!count)
+    {
+        std::cerr << "no numbers in the input" << std::endl;
+
+        return 1;
+    }
 
-    std::cout << tmp << std::endl;
+    std::cout << result.value << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}